@@ -4,9 +4,16 @@
 #include <map>
 #include <tuple>
 #include <stdexcept>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
 
 #include "bb_queue.h"
 
+struct thread_pool;
+
 struct bb_improvement_entry {
 	double sum;
 	int count;
@@ -28,11 +35,11 @@ struct bb_context {
 
 	static constexpr bb_opt_direction opt_dir = queue_type::opt_dir;
 
-	// Queue
+	// Queue (shared by the workers, guarded by mutex)
 	queue_type queue;
 
-	// Best node
-	double best_obj;
+	// Best node (best_obj is read without the lock for pruning)
+	std::atomic<double> best_obj;
 	node_type* best_node;
 
 	// Improvement history
@@ -42,10 +49,10 @@ struct bb_context {
 	std::chrono::time_point<std::chrono::high_resolution_clock> start_time;
 	double print_interval;
 	double last_print_time;
-	int node_count;
-	int step_count;
-	int branch_cat_count[3];
-	int strong_eval;
+	std::atomic<int> node_count;
+	std::atomic<int> step_count;
+	std::atomic<int> branch_cat_count[3];
+	std::atomic<int> strong_eval;
 	double strong_eval_time;
 
 	// Parameters
@@ -53,6 +60,20 @@ struct bb_context {
 	int reliable_threshold;
 	int reliable_lookahead;
 	int heuristic_freq;
+	int num_threads;
+	int strong_threads;		// Strong branching evaluations run concurrently by each worker
+
+	// Parallel solve: workers take nodes from the queue, worker 0 is the calling thread
+	static thread_local int worker;
+	std::mutex mutex;
+	std::mutex history_mutex;
+	std::condition_variable queue_cv;
+	std::vector<double> worker_bounds;		// Bound of the node processed by each worker
+	int busy_workers;
+	bool stopping;
+
+	// Strong branching: the evaluations of worker w run on its pool, job i on the slot get_evaluator_slot(w, i)
+	std::vector<std::unique_ptr<thread_pool>> strong_pools;
 
 	// Constructor
 	bb_context();
@@ -61,6 +82,10 @@ struct bb_context {
 	// Solution
 	bool solve();
 	void step(node_type* node);
+	bool process(node_type* node);
+	void work(int worker_index);
+	void evaluate_wave(node_type* node, const std::vector<candidate_type>& candidates, const std::vector<int>& wave,
+					   std::vector<double>& down_imprs, std::vector<double>& up_imprs);
 
 	// Helpers
 	void add_new_solution(node_type* node);
@@ -77,12 +102,20 @@ struct bb_context {
 	virtual void enter_node(node_type* node) {}
 	virtual void run_heuristic(node_type* node) {}
 
+	// Called before a parallel solve, the callbacks of worker w run on its own thread (see worker)
+	// With strong_threads > 1, it also provides the evaluator slots (worker is then the slot index)
+	virtual void prepare_workers(int num_workers) {}
+
+	// Moves the current evaluator slot to an entered node before evaluate_branch, the node is only read
+	virtual void enter_evaluator(node_type* node) {}
+
 	// Query
 	double get_current_time() const;
 	double get_best_bound() const;
 	double get_best_obj() const;
 	double get_gap_ratio() const;
 	int get_branch_category_count(int i) const;
+	int get_evaluator_slot(int owner, int i) const;
 
 	// Print
 	void print_header() const;
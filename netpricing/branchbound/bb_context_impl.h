@@ -1,11 +1,16 @@
 #pragma once
 
 #include "bb_context.h"
+#include "../utilities/thread_pool.h"
 
 #include <algorithm>
 #include <utility>
 #include <iostream>
 #include <numeric>
+#include <thread>
+
+template <typename _queue_type>
+thread_local int bb_context<_queue_type>::worker = 0;
 
 template <typename _queue_type>
 inline bb_context<_queue_type>::bb_context() : queue(), branch_cat_count{0,0,0}
@@ -27,6 +32,11 @@ inline bb_context<_queue_type>::bb_context() : queue(), branch_cat_count{0,0,0}
 	reliable_threshold = 8;
 	reliable_lookahead = 4;
 	heuristic_freq = 100;
+	num_threads = 1;
+	strong_threads = 1;
+
+	busy_workers = 0;
+	stopping = false;
 }
 
 template<typename _queue_type>
@@ -60,38 +70,106 @@ inline bool bb_context<_queue_type>::solve()
 			queue.push(root_node);
 	}
 
-	// Check the queue
-	while (!queue.empty()) {
-		// Fetch the node
-		node_type* node = queue.next();
-		queue.pop();
+	// Evaluator slots and their threads, one pool per worker
+	const int num_workers = std::max(1, num_threads);
+	if (strong_threads > 1) {
+		prepare_workers(num_workers * strong_threads);
+		while ((int)strong_pools.size() < num_workers)
+			strong_pools.emplace_back(new thread_pool(strong_threads));
+	}
+
+	// Serial solve
+	if (num_threads <= 1) {
+		while (!queue.empty()) {
+			// Fetch the node
+			node_type* node = queue.next();
+			queue.pop();
+
+			if (!process(node))
+				break;
+		}
+		return best_node != nullptr;
+	}
+
+	// Parallel solve
+	prepare_workers(num_threads);
 
-		// Print (time-based)
+	worker_bounds.assign(num_threads, default_obj<opt_dir>());
+	busy_workers = 0;
+	stopping = false;
+
+	vector<thread> threads;
+	for (int w = 1; w < num_threads; w++)
+		threads.emplace_back(&bb_context::work, this, w);
+	work(0);
+	for (auto& t : threads)
+		t.join();
+
+	worker = 0;
+	worker_bounds.clear();
+
+	return best_node != nullptr;
+}
+
+template <typename _queue_type>
+inline bool bb_context<_queue_type>::process(node_type* node)
+{
+	// Print (time-based)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
 		if (get_current_time() >= last_print_time + print_interval) {
 			print_node(node);
 			last_print_time = get_current_time();
 		}
+	}
 
-		// Process the node
-		step(node);
+	// Process the node
+	step(node);
 
-		// Heuristic
-		if (heuristic_freq > 0 && step_count % heuristic_freq == 0) {
-			run_heuristic(node);
-		}
+	// Heuristic
+	int step_index = step_count++;
+	if (heuristic_freq > 0 && step_index % heuristic_freq == 0) {
+		run_heuristic(node);
+	}
 
-		// Delete the old node
-		delete node;
+	// Delete the old node
+	delete node;
 
-		// Statistics
-		step_count++;
+	// Time limit
+	return !(time_limit > 0 && get_current_time() >= time_limit);
+}
 
-		// Time limit
-		if (time_limit > 0 && get_current_time() >= time_limit)
+template <typename _queue_type>
+inline void bb_context<_queue_type>::work(int worker_index)
+{
+	worker = worker_index;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		// Wait for a node, the search is over when the queue is empty and no worker may add children
+		queue_cv.wait(lock, [this]() { return stopping || !queue.empty() || busy_workers == 0; });
+		if (stopping || queue.empty())
 			break;
+
+		node_type* node = queue.next();
+		queue.pop();
+		busy_workers++;
+		worker_bounds[worker] = node->get_bound();
+
+		// Nodes are processed concurrently, the queue is only locked to fetch and append
+		lock.unlock();
+		bool go_on = process(node);
+		lock.lock();
+
+		busy_workers--;
+		worker_bounds[worker] = default_obj<opt_dir>();
+		if (!go_on)
+			stopping = true;
+
+		queue_cv.notify_all();
 	}
 
-	return best_node != nullptr;
+	queue_cv.notify_all();
 }
 
 template <typename _queue_type>
@@ -132,47 +210,72 @@ inline void bb_context<_queue_type>::step(node_type* node)
 	int lookahead_counter = 0;
 	bool updated = false;		// If this is true, we don't update the pseudo cost in the branch stage to avoid repetition
 
-	// Loop from the largest pseudo cost
-	for (int i : idx) {
-		const candidate_type& candidate = candidates[i];
-		if (is_pseudo_score_reliable(candidate, reliable_threshold))
-			continue;
+	// Loop from the largest pseudo cost, the unreliable candidates are evaluated in waves of strong_threads
+	// A wave is merged in score order with the same early termination as one candidate at a time
+	const int wave_capacity = std::max(1, strong_threads);
+	vector<int> wave;
+	vector<double> down_imprs, up_imprs;
+	bool stop = false;
+
+	for (auto it = idx.begin(); it != idx.end() && !stop;) {
+		wave.clear();
+		for (; it != idx.end() && (int)wave.size() < wave_capacity; it++) {
+			if (!is_pseudo_score_reliable(candidates[*it], reliable_threshold))
+				wave.push_back(*it);
+		}
+		if (wave.empty())
+			break;
 
-		// Evaluate the improvement (negative means infeasible branch)
+		// Evaluate the improvements (negative means infeasible branch)
 		auto substart = std::chrono::high_resolution_clock::now();
 
-		double down_impr = evaluate_branch(node, candidate, false);
-		double up_impr = evaluate_branch(node, candidate, true);
+		evaluate_wave(node, candidates, wave, down_imprs, up_imprs);
 
 		auto subend = std::chrono::high_resolution_clock::now();
-		strong_eval_time += std::chrono::duration<double>(subend - substart).count();
-		strong_eval++;
-
-		// Update the pseudocost
-		if (down_impr >= 0)
-			impr_history[make_tuple(candidate, false)].push(down_impr);
-		if (up_impr >= 0)
-			impr_history[make_tuple(candidate, true)].push(up_impr);
-
-		// Test for special cases (less than 2 feasible branches)
-		if (down_impr < 0 || up_impr < 0) {
-			best_candidate = &candidate;
-			updated = true;
-			break;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			strong_eval_time += std::chrono::duration<double>(subend - substart).count();
+			strong_eval += wave.size();
 		}
 
-		// Update the best score
-		double score = calculate_score(down_impr, up_impr);
-		if (score > best_score) {
-			best_score = score;
-			best_candidate = &candidate;
-			lookahead_counter = 0;
-			updated = true;
+		// Update the pseudocost, for every evaluated candidate
+		{
+			std::lock_guard<std::mutex> lock(history_mutex);
+			for (int w = 0; w < (int)wave.size(); w++) {
+				const candidate_type& candidate = candidates[wave[w]];
+				if (down_imprs[w] >= 0)
+					impr_history[make_tuple(candidate, false)].push(down_imprs[w]);
+				if (up_imprs[w] >= 0)
+					impr_history[make_tuple(candidate, true)].push(up_imprs[w]);
+			}
 		}
-		else {
-			lookahead_counter++;
-			if (lookahead_counter >= reliable_lookahead)
+
+		for (int w = 0; w < (int)wave.size() && !stop; w++) {
+			const candidate_type& candidate = candidates[wave[w]];
+			double down_impr = down_imprs[w];
+			double up_impr = up_imprs[w];
+
+			// Test for special cases (less than 2 feasible branches)
+			if (down_impr < 0 || up_impr < 0) {
+				best_candidate = &candidate;
+				updated = true;
+				stop = true;
 				break;
+			}
+
+			// Update the best score
+			double score = calculate_score(down_impr, up_impr);
+			if (score > best_score) {
+				best_score = score;
+				best_candidate = &candidate;
+				lookahead_counter = 0;
+				updated = true;
+			}
+			else {
+				lookahead_counter++;
+				if (lookahead_counter >= reliable_lookahead)
+					stop = true;
+			}
 		}
 	}
 
@@ -195,6 +298,7 @@ inline void bb_context<_queue_type>::step(node_type* node)
 			// Record the improvement
 			if (!updated) {
 				double impr = abs(child_node->get_bound() - node->get_bound());
+				std::lock_guard<std::mutex> lock(history_mutex);
 				impr_history[make_tuple(*best_candidate, branch_dir)].push(impr);
 			}
 
@@ -217,16 +321,67 @@ inline void bb_context<_queue_type>::step(node_type* node)
 		}
 	}
 
-	// Add the new nodes to the queue
-	queue.append(children);
-
 	// Statistics
 	branch_cat_count[children.size()]++;
+
+	// Add the new nodes to the queue, without those pruned by an incumbent found by another worker meanwhile
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto pruned = std::partition(children.begin(), children.end(),
+									 [this](node_type* child) { return is_better_obj<opt_dir>(child->get_bound(), best_obj); });
+		for (auto it = pruned; it != children.end(); it++)
+			delete (*it);
+		children.erase(pruned, children.end());
+
+		queue.append(children);
+	}
+	queue_cv.notify_all();
+}
+
+template <typename _queue_type>
+inline void bb_context<_queue_type>::evaluate_wave(node_type* node, const std::vector<candidate_type>& candidates,
+												   const std::vector<int>& wave,
+												   std::vector<double>& down_imprs, std::vector<double>& up_imprs)
+{
+	down_imprs.assign(wave.size(), -1);
+	up_imprs.assign(wave.size(), -1);
+
+	auto evaluate = [&](int i) {
+		const candidate_type& candidate = candidates[wave[i]];
+		down_imprs[i] = evaluate_branch(node, candidate, false);
+		up_imprs[i] = evaluate_branch(node, candidate, true);
+	};
+
+	if (wave.size() == 1 || worker >= (int)strong_pools.size()) {
+		for (int i = 0; i < (int)wave.size(); i++)
+			evaluate(i);
+		return;
+	}
+
+	// Job i owns the evaluator slot i of this worker (slot 0 is the worker itself, already at the node)
+	const int owner = worker;
+	strong_pools[owner]->run(wave.size(), [&](int i) {
+		worker = get_evaluator_slot(owner, i);
+		if (i > 0)
+			enter_evaluator(node);
+		evaluate(i);
+		worker = owner;
+	});
+	worker = owner;
+}
+
+template <typename _queue_type>
+inline int bb_context<_queue_type>::get_evaluator_slot(int owner, int i) const
+{
+	if (i == 0)
+		return owner;
+	return std::max(1, num_threads) + owner * (strong_threads - 1) + (i - 1);
 }
 
 template <typename _queue_type>
 inline void bb_context<_queue_type>::add_new_solution(node_type* node)
 {
+	std::lock_guard<std::mutex> lock(mutex);
 	if (is_better_obj<opt_dir>(node->get_bound(), best_obj)) {
 		// Save the new node
 		best_obj = node->get_bound();
@@ -253,6 +408,7 @@ inline double bb_context<_queue_type>::calculate_score(double first_impr, double
 template <typename _queue_type>
 inline double bb_context<_queue_type>::get_candidate_pseudo_score(const candidate_type& candidate)
 {
+	std::lock_guard<std::mutex> lock(history_mutex);
 	double down_cost = impr_history[std::make_tuple(candidate, false)].average();
 	double up_cost = impr_history[std::make_tuple(candidate, true)].average();
 	return calculate_score(down_cost, up_cost);
@@ -261,6 +417,7 @@ inline double bb_context<_queue_type>::get_candidate_pseudo_score(const candidat
 template<typename _queue_type>
 inline bool bb_context<_queue_type>::is_pseudo_score_reliable(const candidate_type& candidate, int threshold)
 {
+	std::lock_guard<std::mutex> lock(history_mutex);
 	double down_count = impr_history[std::make_tuple(candidate, false)].count;
 	double up_count = impr_history[std::make_tuple(candidate, true)].count;
 	return down_count >= threshold && up_count >= threshold;
@@ -275,7 +432,12 @@ inline double bb_context<_queue_type>::get_current_time() const {
 template<typename _queue_type>
 inline double bb_context<_queue_type>::get_best_bound() const {
 	double best_bound = queue.get_best_bound();
-	return is_better_obj<opt_dir>(best_bound, best_obj) ? best_bound : best_obj;
+	for (double bound : worker_bounds)
+		if (is_better_obj<opt_dir>(bound, best_bound))
+			best_bound = bound;
+
+	double obj = best_obj;
+	return is_better_obj<opt_dir>(best_bound, obj) ? best_bound : obj;
 }
 
 template<typename _queue_type>
@@ -308,7 +470,7 @@ inline void bb_context<_queue_type>::print_node(node_type* node, bool is_solutio
 {
 	printf("%s%6d %6d  %5d   %10.2f   %10.2f   %10.2f %6.2f %6.0f        %6d %6d  %6d (%5.1f)",
 		   is_solution ? "*" : " ",
-		   step_count,
+		   step_count.load(),
 		   queue.size(),
 		   node->get_depth(),
 		   node->get_bound(),
@@ -318,7 +480,7 @@ inline void bb_context<_queue_type>::print_node(node_type* node, bool is_solutio
 		   get_current_time(),
 		   node->id,
 		   node->parent,
-		   strong_eval,
+		   strong_eval.load(),
 		   strong_eval_time
 		   );
 	std::cout << std::endl;
@@ -12,13 +12,19 @@ struct bb_node {
 	typename bb_lineage_node<candidate_type>::ptr_type lineage_node;
 
 	bb_node() : id(0), parent(-1), lineage_node(nullptr) {}
+	virtual ~bb_node() = default;
 
 	virtual bb_node* clone() const = 0;
 
 	virtual double get_bound() const = 0;
 	virtual const std::vector<candidate_type>& get_candidates() const = 0;
 
-	bool is_solution() const {
+	// Estimated bytes held by the node, used by the memory-bounded queues
+	virtual size_t get_memory_usage() const {
+		return sizeof(*this);
+	}
+
+	virtual bool is_solution() const {
 		return get_candidates().size() == 0;
 	}
 	int get_depth() const {
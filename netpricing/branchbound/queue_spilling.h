@@ -0,0 +1,62 @@
+#pragma once
+
+#include "queue_hybrid.h"
+#include "bb_lineage_node.h"
+
+#include <map>
+#include <unordered_map>
+#include <fstream>
+#include <string>
+#include <cstdint>
+
+// Hybrid queue with a memory budget
+// Beyond the budget, the worst nodes of the multiset are written to a spill file (bound and lineage only)
+// and reloaded when they become the best; reloaded nodes are rebuilt from their lineage by the context
+// node_type must provide get_memory_usage() and restore(bound), the candidates must be trivially copyable
+template <typename node_type, bb_opt_direction opt_dir>
+struct queue_spilling : public queue_hybrid<node_type, opt_dir>
+{
+	using base_type = queue_hybrid<node_type, opt_dir>;
+	using candidate_type = typename node_type::candidate_type;
+	using lineage_type = bb_lineage_node<candidate_type>;
+
+	struct better_obj {
+		bool operator()(double lhs, double rhs) const { return is_better_obj<opt_dir>(lhs, rhs); }
+	};
+
+	// Parameters: budget in bytes (0 = no limit), directory of the spill file (empty = temporary directory)
+	size_t memory_limit;
+	std::string spill_dir;
+
+	// Estimated usage of the nodes in RAM (recorded on insertion)
+	size_t memory_usage;
+	std::unordered_map<const node_type*, size_t> node_sizes;
+
+	// Spilled nodes: bound -> offset of the record
+	std::multimap<double, uint64_t, better_obj> spilled;
+	std::fstream spill_file;
+	std::string spill_path;
+	uint64_t spill_end;
+
+	// Statistics
+	int spill_count;
+	int reload_count;
+
+	queue_spilling();
+	virtual ~queue_spilling();
+
+	virtual int size() const override;
+	virtual void pop() override;
+	virtual void append(const std::vector<node_type*>& nodes) override;
+	virtual void prune(double new_obj) override;
+	virtual double get_best_bound() const override;
+
+private:
+	void track(node_type* node);
+	void untrack(node_type* node);
+	void rebalance();
+	void spill(node_type* node);
+	node_type* reload(uint64_t offset);
+	void open_spill_file();
+	void reset_spill_file();
+};
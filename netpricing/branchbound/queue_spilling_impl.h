@@ -0,0 +1,220 @@
+#pragma once
+
+#include "queue_spilling.h"
+#include "queue_hybrid_impl.h"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <experimental/filesystem>
+
+template <typename node_type, bb_opt_direction opt_dir>
+inline queue_spilling<node_type, opt_dir>::queue_spilling() :
+	memory_limit(0), memory_usage(0), spill_end(0), spill_count(0), reload_count(0)
+{
+	static_assert(std::is_trivially_copyable<candidate_type>::value, "Spilled candidates are written as raw bytes");
+}
+
+template <typename node_type, bb_opt_direction opt_dir>
+inline queue_spilling<node_type, opt_dir>::~queue_spilling()
+{
+	if (spill_file.is_open()) {
+		spill_file.close();
+		std::error_code ec;
+		std::experimental::filesystem::remove(spill_path, ec);
+	}
+}
+
+template <typename node_type, bb_opt_direction opt_dir>
+inline int queue_spilling<node_type, opt_dir>::size() const
+{
+	return base_type::size() + spilled.size();
+}
+
+template <typename node_type, bb_opt_direction opt_dir>
+inline void queue_spilling<node_type, opt_dir>::pop()
+{
+	untrack(this->next());
+	base_type::pop();
+	rebalance();
+}
+
+template <typename node_type, bb_opt_direction opt_dir>
+inline void queue_spilling<node_type, opt_dir>::append(const std::vector<node_type*>& nodes)
+{
+	for (node_type* node : nodes)
+		track(node);
+	base_type::append(nodes);
+	rebalance();
+}
+
+template <typename node_type, bb_opt_direction opt_dir>
+inline void queue_spilling<node_type, opt_dir>::prune(double new_obj)
+{
+	auto& mset = this->mset;
+	auto& next_node = this->next_node;
+
+	auto remove_it = mset.lower_bound(new_obj);
+	for (auto it = remove_it; it != mset.end(); it++)
+		untrack(*it);
+	if (next_node && !is_better_obj<opt_dir>(next_node->get_bound(), new_obj))
+		untrack(next_node);
+	base_type::prune(new_obj);
+
+	// Spilled records are dropped from the index, their space is reclaimed when the file empties
+	spilled.erase(spilled.lower_bound(new_obj), spilled.end());
+	if (spilled.empty())
+		reset_spill_file();
+
+	rebalance();
+}
+
+template <typename node_type, bb_opt_direction opt_dir>
+inline double queue_spilling<node_type, opt_dir>::get_best_bound() const
+{
+	double ram_obj = base_type::get_best_bound();
+	double spilled_obj = spilled.empty() ? default_obj<opt_dir>() : spilled.begin()->first;
+	return is_better_obj<opt_dir>(spilled_obj, ram_obj) ? spilled_obj : ram_obj;
+}
+
+template <typename node_type, bb_opt_direction opt_dir>
+inline void queue_spilling<node_type, opt_dir>::track(node_type* node)
+{
+	size_t node_size = node->get_memory_usage();
+	node_sizes[node] = node_size;
+	memory_usage += node_size;
+}
+
+template <typename node_type, bb_opt_direction opt_dir>
+inline void queue_spilling<node_type, opt_dir>::untrack(node_type* node)
+{
+	auto it = node_sizes.find(node);
+	if (it == node_sizes.end())
+		return;
+	memory_usage -= it->second;
+	node_sizes.erase(it);
+}
+
+template <typename node_type, bb_opt_direction opt_dir>
+inline void queue_spilling<node_type, opt_dir>::rebalance()
+{
+	auto& mset = this->mset;
+
+	// Spill the worst nodes of the multiset, the diving node stays
+	if (memory_limit > 0) {
+		while (memory_usage > memory_limit && !mset.empty()) {
+			auto worst_it = std::prev(mset.end());
+			node_type* node = *worst_it;
+			mset.erase(worst_it);
+
+			untrack(node);
+			spill(node);
+			delete node;
+		}
+	}
+
+	// Reload the best spilled node when it beats the multiset, so next() and the bound stay exact
+	while (!spilled.empty() && (mset.empty() || is_better_obj<opt_dir>(spilled.begin()->first, (*mset.begin())->get_bound()))) {
+		uint64_t offset = spilled.begin()->second;
+		spilled.erase(spilled.begin());
+
+		node_type* node = reload(offset);
+		track(node);
+		mset.insert(node);
+
+		if (spilled.empty())
+			reset_spill_file();
+	}
+}
+
+template <typename node_type, bb_opt_direction opt_dir>
+inline void queue_spilling<node_type, opt_dir>::spill(node_type* node)
+{
+	if (!spill_file.is_open())
+		open_spill_file();
+
+	std::vector<typename lineage_type::data_type> lineage;
+	if (node->lineage_node != nullptr)
+		lineage = node->lineage_node->get_full_lineage();
+
+	// Record: bound, id, parent, depth, then (candidate, direction) from the root
+	double bound = node->get_bound();
+	int32_t header[3] = { node->id, node->parent, (int32_t)lineage.size() };
+
+	spill_file.seekp(spill_end);
+	spill_file.write(reinterpret_cast<const char*>(&bound), sizeof(bound));
+	spill_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	for (const auto& entry : lineage) {
+		uint8_t branch_dir = std::get<1>(entry);
+		spill_file.write(reinterpret_cast<const char*>(&std::get<0>(entry)), sizeof(candidate_type));
+		spill_file.write(reinterpret_cast<const char*>(&branch_dir), sizeof(branch_dir));
+	}
+	if (!spill_file)
+		throw std::runtime_error("Queue error: cannot write to the spill file " + spill_path);
+
+	spilled.emplace(bound, spill_end);
+	spill_end = spill_file.tellp();
+	spill_count++;
+}
+
+template <typename node_type, bb_opt_direction opt_dir>
+inline node_type* queue_spilling<node_type, opt_dir>::reload(uint64_t offset)
+{
+	double bound;
+	int32_t header[3];
+
+	spill_file.seekg(offset);
+	spill_file.read(reinterpret_cast<char*>(&bound), sizeof(bound));
+	spill_file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+	typename lineage_type::ptr_type lineage = nullptr;
+	for (int i = 0; i < header[2]; i++) {
+		candidate_type candidate;
+		uint8_t branch_dir;
+		spill_file.read(reinterpret_cast<char*>(&candidate), sizeof(candidate_type));
+		spill_file.read(reinterpret_cast<char*>(&branch_dir), sizeof(branch_dir));
+		lineage = std::make_shared<lineage_type>(lineage, candidate, (bool)branch_dir);
+	}
+	if (!spill_file)
+		throw std::runtime_error("Queue error: cannot read from the spill file " + spill_path);
+
+	node_type* node = new node_type();
+	node->id = header[0];
+	node->parent = header[1];
+	node->lineage_node = lineage;
+	node->restore(bound);
+
+	reload_count++;
+	return node;
+}
+
+template <typename node_type, bb_opt_direction opt_dir>
+inline void queue_spilling<node_type, opt_dir>::open_spill_file()
+{
+	namespace fs = std::experimental::filesystem;
+
+	fs::path dir = spill_dir.empty() ? fs::temp_directory_path() : fs::path(spill_dir);
+	std::string name = "netpricing-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) +
+		"-" + std::to_string(reinterpret_cast<uintptr_t>(this)) + ".spill";
+	spill_path = (dir / name).string();
+
+	spill_file.open(spill_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!spill_file)
+		throw std::runtime_error("Queue error: cannot open the spill file " + spill_path);
+	spill_end = 0;
+}
+
+template <typename node_type, bb_opt_direction opt_dir>
+inline void queue_spilling<node_type, opt_dir>::reset_spill_file()
+{
+	if (!spill_file.is_open() || spill_end == 0)
+		return;
+
+	// No live record left, start over at the beginning
+	spill_file.close();
+	spill_file.open(spill_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!spill_file)
+		throw std::runtime_error("Queue error: cannot open the spill file " + spill_path);
+	spill_end = 0;
+}
@@ -1,6 +1,6 @@
 #include "csenum_context.h"
 
-#include "../branchbound/queue_hybrid_impl.h"
+#include "../branchbound/queue_spilling_impl.h"
 #include "../branchbound/bb_context_impl.h"
 #include "../macros.h"
 
@@ -11,39 +11,49 @@ static const double TOLERANCE = 1e-4;
 template struct bb_context<csenum_queue>;
 
 csenum_context::csenum_context(csenum_solver_base* _solver) :
-	solver(_solver), env(_solver->env), prob(_solver->prob),
-	K(solver->K), V(solver->V), A(solver->A), A1(solver->A1), A2(solver->A2),
+	env(_solver->env), solvers{ _solver }, solver_lineages(1), prob(_solver->prob),
+	K(_solver->K), V(_solver->V), A(_solver->A), A1(_solver->A1), A2(_solver->A2),
 	heur(env, prob)
 {
 }
 
 csenum_context::~csenum_context()
 {
-	delete solver;
+	for (auto worker_solver : solvers)
+		delete worker_solver;
+	worker_heurs.clear();
+	for (auto& worker_env : worker_envs)
+		worker_env.end();
 }
 
 bool csenum_context::update_root_bound(node_type* node)
 {
-	solver->clear_primal_state();
-	solver->clear_dual_state();
+	solver()->clear_primal_state();
+	solver()->clear_dual_state();
+	solver_lineages[worker] = nullptr;
 
-	solver->solve_primals();
-	solver->solve_dual();
+	return build_node(node);
+}
 
-	node->primal_objs = solver->get_primal_costs();
-	node->dual_obj = solver->get_dual_cost();
-	node->bound = node->dual_obj;
-	LOOP(k, K) node->bound -= prob.commodities[k].demand * node->primal_objs[k];
+bool csenum_context::build_node(node_type* node)
+{
+	// Full solve in the current solver state
+	solver()->solve_primals();
+	solver()->solve_dual();
 
-	node->arcs = solver->get_all_primal_arcs();
+	auto primal = make_shared<csenum_primal_data>();
+	primal->k = -1;
+	primal->objs = solver()->get_primal_costs();
+	primal->arcs = solver()->get_all_primal_arcs();
 
-	auto tvals = solver->get_t();
-	LOOP(a, A1) node->tolls.push_back(tvals[a]);
-	tvals.end();
+	node->primal = std::move(primal);
+	node->dual = make_dual_data();
+	node->materialize(K);
 
-	update_slack_map(node);
+	node->bound = node->dual->obj;
+	LOOP(k, K) node->bound -= prob.commodities[k].demand * node->primal_objs[k];
 
-	update_candidate_list(node);
+	node->has_candidates = !node->get_candidates().empty();
 
 	return true;
 }
@@ -53,56 +63,62 @@ bool csenum_context::update_bound(node_type* node, node_type* parent_node, const
 	bool is_feasible;
 
 	if (branch_dir == PRIMAL) {
-		solver->push_primal_state(coor);
+		solver()->push_primal_state(coor);
 
 		int k = coor.k;
-		is_feasible = solver->solve_primal(k);
+		is_feasible = solver()->solve_primal(k);
 		if (!is_feasible) {
-			solver->pop_primal_state();
+			solver()->pop_primal_state();
 			return false;
 		}
 
-		node->primal_objs = parent_node->primal_objs;
-		node->arcs = parent_node->arcs;
+		// Only the new path is stored, the dual solution is the parent's
+		auto delta = make_shared<csenum_primal_data>();
+		delta->base = parent_node->primal;
+		delta->k = k;
+		delta->objs.push_back(solver()->get_primal_cost(k));
+		delta->arcs.push_back(solver()->get_primal_arcs(k));
+
+		node->dual = parent_node->dual;
 
-		node->primal_objs[k] = solver->get_primal_cost(k);
-		node->arcs[k] = solver->get_primal_arcs(k);
+		node->bound = node->dual->obj;
+		LOOP(k2, K) node->bound -= prob.commodities[k2].demand * (k2 == k ? delta->objs[0] : parent_node->primal_objs[k2]);
 
-		node->dual_obj = parent_node->dual_obj;
-		node->tolls = parent_node->tolls;
-		node->slack_map = parent_node->slack_map;
+		// Leaf if no other path has candidates under the same dual, and neither has the new one
+		node->has_candidates = false;
+		for (const auto& parent_coor : parent_node->get_candidates())
+			node->has_candidates |= (parent_coor.k != k);
+		for (int a : delta->arcs[0])
+			node->has_candidates |= node->dual->slack_map[k][a];
 
-		solver->pop_primal_state();
+		node->primal = std::move(delta);
+
+		solver()->pop_primal_state();
 	}
 	else {
-		solver->push_dual_state(coor);
-		is_feasible = solver->solve_dual();
+		solver()->push_dual_state(coor);
+		is_feasible = solver()->solve_dual();
 		if (!is_feasible) {
-			solver->pop_dual_state();
+			solver()->pop_dual_state();
 			return false;
 		}
 
-		node->primal_objs = parent_node->primal_objs;
-		node->arcs = parent_node->arcs;
-
-		node->dual_obj = solver->get_dual_cost();
+		// Same paths as the parent, a new dual solution
+		node->primal = parent_node->primal;
+		node->dual = make_dual_data();
 
-		auto tvals = solver->get_t();
-		LOOP(a, A1) node->tolls.push_back(tvals[a]);
-		tvals.end();
+		node->bound = node->dual->obj;
+		LOOP(k, K) node->bound -= prob.commodities[k].demand * parent_node->primal_objs[k];
 
-		update_slack_map(node);
+		node->has_candidates = false;
+		LOOP(k, K) {
+			for (int a : parent_node->arcs[k])
+				node->has_candidates |= node->dual->slack_map[k][a];
+		}
 
-		solver->pop_dual_state();
+		solver()->pop_dual_state();
 	}
 
-	// Update overall bound
-	node->bound = node->dual_obj;
-	LOOP(k, K) node->bound -= prob.commodities[k].demand * node->primal_objs[k];
-
-	// Update candidate list
-	update_candidate_list(node);
-
 	return true;
 }
 
@@ -112,32 +128,32 @@ double csenum_context::evaluate_branch(node_type* node, const candidate_type& co
 	double result;
 
 	if (branch_dir == PRIMAL) {
-		solver->push_primal_state(coor);
+		solver()->push_primal_state(coor);
 
 		int k = coor.k;
-		is_feasible = solver->solve_primal(k);
+		is_feasible = solver()->solve_primal(k);
 		if (!is_feasible) {
-			solver->pop_primal_state();
+			solver()->pop_primal_state();
 			return -1;
 		}
 
-		double new_obj = solver->get_primal_cost(k);
+		double new_obj = solver()->get_primal_cost(k);
 		result = (new_obj - node->primal_objs[k]) * prob.commodities[k].demand;
 
-		solver->pop_primal_state();
+		solver()->pop_primal_state();
 	}
 	else {
-		solver->push_dual_state(coor);
-		is_feasible = solver->solve_dual();
+		solver()->push_dual_state(coor);
+		is_feasible = solver()->solve_dual();
 		if (!is_feasible) {
-			solver->pop_dual_state();
+			solver()->pop_dual_state();
 			return -1;
 		}
 
-		double new_obj = solver->get_dual_cost();
-		result = node->dual_obj - new_obj;
+		double new_obj = solver()->get_dual_cost();
+		result = node->dual->obj - new_obj;
 
-		solver->pop_dual_state();
+		solver()->pop_dual_state();
 	}
 
 	return result;
@@ -145,25 +161,102 @@ double csenum_context::evaluate_branch(node_type* node, const candidate_type& co
 
 void csenum_context::enter_node(node_type* node)
 {
-	solver->clear_primal_state();
-	solver->clear_dual_state();
+	move_solver(node->lineage_node);
 
-	if (node->lineage_node == nullptr)
-		return;
+	// Nodes reloaded from the spill file are solved again, the others only rebuild their paths
+	if (node->is_restored())
+		build_node(node);
+	else
+		node->materialize(K);
+}
 
-	auto lineage = node->lineage_node->get_full_lineage();
+void csenum_context::enter_evaluator(node_type* node)
+{
+	move_solver(node->lineage_node);
+}
 
-	for (const auto& entry : lineage) {
-		if (get<1>(entry) == PRIMAL)
-			solver->push_primal_state(get<0>(entry));
-		else
-			solver->push_dual_state(get<0>(entry));
+void csenum_context::move_solver(const lineage_ptr& lineage)
+{
+	// Move the solver from its lineage to the target: undo the branches up to the common ancestor, then apply the new ones
+	// A child entered right after its parent only costs one push
+	lineage_ptr from = solver_lineages[worker];
+	lineage_ptr to = lineage;
+
+	int from_depth = from ? from->get_depth() : 0;
+	int to_depth = to ? to->get_depth() : 0;
+
+	vector<lineage_ptr> pops, pushes;
+	while (from_depth > to_depth) {
+		pops.push_back(from);
+		from = from->parent;
+		from_depth--;
+	}
+	while (to_depth > from_depth) {
+		pushes.push_back(to);
+		to = to->parent;
+		to_depth--;
+	}
+
+	// Same depth, walk up to the common ancestor
+	int common = 0;
+	while (from != to) {
+		pops.push_back(from);
+		from = from->parent;
+		pushes.push_back(to);
+		to = to->parent;
+		common++;
+	}
+
+	// Lineages reloaded from a spill file are new objects, the branches equal below the common ancestor are kept
+	int kept = 0;
+	while (kept < common && pops[pops.size() - 1 - kept]->data == pushes[pushes.size() - 1 - kept]->data)
+		kept++;
+
+	for (int i = 0; i < (int)pops.size() - kept; i++)
+		pop_lineage_entry(pops[i]);
+	for (int i = (int)pushes.size() - 1 - kept; i >= 0; i--)
+		push_lineage_entry(pushes[i]);
+
+	solver_lineages[worker] = lineage;
+}
+
+void csenum_context::push_lineage_entry(const lineage_ptr& entry)
+{
+	if (get<1>(entry->data) == PRIMAL)
+		solver()->push_primal_state(get<0>(entry->data));
+	else
+		solver()->push_dual_state(get<0>(entry->data));
+}
+
+void csenum_context::pop_lineage_entry(const lineage_ptr& entry)
+{
+	if (get<1>(entry->data) == PRIMAL)
+		solver()->pop_primal_state();
+	else
+		solver()->pop_dual_state();
+}
+
+void csenum_context::prepare_workers(int num_workers)
+{
+	// The clones share the problem, they start at the root state (also used as strong branching evaluators)
+	while ((int)solvers.size() < num_workers) {
+		worker_envs.emplace_back();
+		solvers.push_back(solvers[0]->clone(worker_envs.back()));
+		solver_lineages.emplace_back();
+	}
+
+	// Concert environments are not thread-safe, each worker runs the heuristic in its own (evaluator slots do not)
+	int num_heurs = min(num_workers, max(1, num_threads));
+	while ((int)worker_heurs.size() < num_heurs - 1) {
+		worker_heurs.emplace_back(new tolls_heuristic(worker_envs[worker_heurs.size()], prob));
+		worker_heurs.back()->solver_f.set_num_threads(heur.solver_f.get_num_threads());
 	}
 }
 
 void csenum_context::run_heuristic(node_type* node)
 {
-	solution sol = heur.solve(node->tolls);
+	solution sol = heuristic().solve(node->dual->tolls);
+
 	cost_type obj = sol.get_obj_value(prob);
 
 	if (obj > get_best_obj()) {
@@ -171,8 +264,12 @@ void csenum_context::run_heuristic(node_type* node)
 		sol_node->id = -1;
 		sol_node->parent = -1;
 		sol_node->bound = obj;
-		sol_node->tolls = std::move(sol.tolls);
-		
+
+		auto sol_dual = make_shared<csenum_dual_data>();
+		sol_dual->obj = obj;
+		sol_dual->tolls = std::move(sol.tolls);
+		sol_node->dual = std::move(sol_dual);
+
 		for (auto& path : sol.paths) {
 			vector<int> arcs;
 			for (int i = 0; i < path.size() - 1; i++) {
@@ -186,12 +283,20 @@ void csenum_context::run_heuristic(node_type* node)
 	}
 }
 
-void csenum_context::update_slack_map(node_type* node)
+shared_ptr<const csenum_dual_data> csenum_context::make_dual_data()
 {
-	node->slack_map = vector<vector<bool>>(K, vector<bool>(A));
+	auto dual = make_shared<csenum_dual_data>();
+	dual->obj = solver()->get_dual_cost();
+
+	auto tvals = solver()->get_t();
+	LOOP(a, A1) dual->tolls.push_back(tvals[a]);
+	tvals.end();
+
+	// Slack map of the solver's dual solution
+	dual->slack_map = vector<vector<bool>>(K, vector<bool>(A));
 
-	auto lambda = solver->get_lambda();
-	auto t = node->tolls;
+	auto lambda = solver()->get_lambda();
+	const auto& t = dual->tolls;
 
 	LOOP(k, K) LOOP(a, A) {
 		SRC_DST_FROM_A(prob, a);
@@ -204,21 +309,11 @@ void csenum_context::update_slack_map(node_type* node)
 			slack += t[EDGE_TO_A1(prob, edge)];
 
 		// Set slack map
-		node->slack_map[k][a] = (abs(slack) > TOLERANCE);
+		dual->slack_map[k][a] = (abs(slack) > TOLERANCE);
 	}
 
 	LOOP(k, K) lambda[k].end();
 	lambda.end();
-}
 
-void csenum_context::update_candidate_list(node_type* node)
-{
-	node->candidates.clear();
-	LOOP(k, K) {
-		for (int a : node->arcs[k]) {
-			if (node->slack_map[k][a]) {
-				node->candidates.push_back(csenum_coor{ .k = k, .a = a });
-			}
-		}
-	}
+	return dual;
 }
@@ -2,20 +2,32 @@
 
 #include "csenum_solver_base.h"
 #include "csenum_node.h"
-#include "../branchbound/queue_hybrid.h"
+#include "../branchbound/queue_spilling.h"
 #include "../branchbound/bb_context.h"
 #include "../heuristics/tolls_heuristic.h"
 
-struct csenum_queue : public queue_hybrid<csenum_node, Maximize> {};
+#include <vector>
+#include <memory>
+
+struct csenum_queue : public queue_spilling<csenum_node, Maximize> {};
 
 struct csenum_context : public bb_context<csenum_queue> {
 	IloEnv env;
-	csenum_solver_base* solver;
 
-	problem& prob;
+	using lineage_ptr = bb_lineage_node<csenum_coor>::ptr_type;
+
+	// One solver per worker and evaluator slot, the others are clones in their own environment
+	// Each solver holds the branching state of a lineage node (nullptr = root)
+	std::vector<csenum_solver_base*> solvers;
+	std::vector<lineage_ptr> solver_lineages;
+	std::vector<IloEnv> worker_envs;
+
+	const problem& prob;
 	int K, V, A, A1, A2;
 
+	// Heuristic of worker 0 (main environment), worker w > 0 has its own in worker_envs[w - 1]
 	tolls_heuristic heur;
+	std::vector<std::unique_ptr<tolls_heuristic>> worker_heurs;
 
 	csenum_context(csenum_solver_base* _solver);
 	virtual ~csenum_context();
@@ -26,9 +38,16 @@ struct csenum_context : public bb_context<csenum_queue> {
 	virtual double evaluate_branch(node_type* node, const candidate_type& candidate, bool branch_dir) override;
 
 	virtual void enter_node(node_type* node) override;
+	virtual void enter_evaluator(node_type* node) override;
 	virtual void run_heuristic(node_type* node) override;
+	virtual void prepare_workers(int num_workers) override;
 
 	// Helper
-	void update_slack_map(node_type* node);
-	void update_candidate_list(node_type* node);
+	csenum_solver_base* solver() { return solvers[worker]; }
+	tolls_heuristic& heuristic() { return worker == 0 ? heur : *worker_heurs[worker - 1]; }
+	bool build_node(node_type* node);
+	void move_solver(const lineage_ptr& lineage);
+	void push_lineage_entry(const lineage_ptr& entry);
+	void pop_lineage_entry(const lineage_ptr& entry);
+	std::shared_ptr<const csenum_dual_data> make_dual_data();
 };
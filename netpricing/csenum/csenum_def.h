@@ -15,4 +15,9 @@ struct csenum_coor {
 	{
 		return std::tie(lhs.k, lhs.a) < std::tie(rhs.k, rhs.a);
 	}
+
+	friend bool operator==(const csenum_coor& lhs, const csenum_coor& rhs)
+	{
+		return lhs.k == rhs.k && lhs.a == rhs.a;
+	}
 };
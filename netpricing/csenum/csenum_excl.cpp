@@ -19,6 +19,11 @@ bool csenum_excl::solve_impl()
 void csenum_excl::config(const model_config& config)
 {
 	context.time_limit = config.time_limit;
+	context.num_threads = config.num_thread;
+	context.strong_threads = config.strong_threads;
+	context.queue.memory_limit = (size_t)config.bb_memory_limit << 20;
+	context.queue.spill_dir = config.bb_spill_dir;
+	context.heur.solver_f.set_num_threads(config.follower_threads);
 }
 
 solution csenum_excl::get_solution()
@@ -3,6 +3,43 @@
 
 using namespace std;
 
+void csenum_node::materialize(int K)
+{
+	if ((int)arcs.size() == K) return;
+
+	// Walk the deltas from the newest, the first one seen for a commodity wins
+	primal_objs.assign(K, 0);
+	arcs.assign(K, vector<int>());
+	vector<bool> done(K, false);
+	int remaining = K;
+
+	for (const csenum_primal_data* delta = primal.get(); delta != nullptr && remaining > 0; delta = delta->base.get()) {
+		if (delta->k >= 0) {
+			if (done[delta->k]) continue;
+			done[delta->k] = true;
+			remaining--;
+			primal_objs[delta->k] = delta->objs[0];
+			arcs[delta->k] = delta->arcs[0];
+		}
+		else {
+			LOOP(k, K) {
+				if (done[k]) continue;
+				primal_objs[k] = delta->objs[k];
+				arcs[k] = delta->arcs[k];
+			}
+			remaining = 0;
+		}
+	}
+}
+
+void csenum_node::restore(double _bound)
+{
+	bound = _bound;
+	has_candidates = true;
+	primal = nullptr;
+	dual = nullptr;
+}
+
 csenum_node* csenum_node::clone() const
 {
 	return new csenum_node(*this);
@@ -15,5 +52,44 @@ double csenum_node::get_bound() const
 
 const std::vector<csenum_coor>& csenum_node::get_candidates() const
 {
+	// Arcs of the paths with a slack reduced cost, the node must be materialized
+	if (!candidates_ready) {
+		candidates.clear();
+		// Heuristic solutions have no slack map
+		if (dual != nullptr && dual->slack_map.size() == arcs.size()) {
+			LOOP(k, (int)arcs.size()) {
+				for (int a : arcs[k]) {
+					if (dual->slack_map[k][a])
+						candidates.push_back(csenum_coor{ .k = k, .a = a });
+				}
+			}
+		}
+		candidates_ready = true;
+	}
 	return candidates;
 }
+
+bool csenum_node::is_solution() const
+{
+	return !has_candidates;
+}
+
+size_t csenum_node::get_memory_usage() const
+{
+	// The newest path delta, and the dual solution split between the nodes sharing it
+	size_t usage = sizeof(*this);
+	if (primal != nullptr) {
+		usage += sizeof(csenum_primal_data) + primal->objs.size() * sizeof(double);
+		for (const auto& path : primal->arcs)
+			usage += sizeof(path) + path.size() * sizeof(int);
+	}
+	if (dual != nullptr) {
+		size_t dual_usage = sizeof(csenum_dual_data) + dual->tolls.size() * sizeof(cost_type);
+		for (const auto& slacks : dual->slack_map)
+			dual_usage += sizeof(slacks) + slacks.size() / 8;
+		usage += dual_usage / dual.use_count();
+	}
+	for (const auto& path : arcs)
+		usage += sizeof(path) + path.size() * sizeof(int);
+	return usage + primal_objs.size() * sizeof(double);
+}
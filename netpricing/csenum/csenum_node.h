@@ -4,20 +4,55 @@
 #include "../typedef.h"
 #include "../branchbound/bb_node.h"
 
+#include <memory>
 #include <vector>
 
+// Dual solution of a node, shared by all its primal descendants
+struct csenum_dual_data {
+	double obj;
+	std::vector<cost_type> tolls;
+	std::vector<std::vector<bool>> slack_map;
+};
+
+// Primal paths as a chain of deltas, a primal branch only replaces one commodity
+struct csenum_primal_data {
+	std::shared_ptr<const csenum_primal_data> base;
+
+	// Commodity replaced by this delta (objs and arcs have one entry), -1 for a full set
+	int k;
+	std::vector<double> objs;
+	std::vector<std::vector<int>> arcs;
+};
+
+// Queued nodes only hold their bound and shared references to immutable data
+// The full paths and the candidates are materialized when the node is entered, and freed with it
 struct csenum_node : public bb_node<csenum_coor> {
-	std::vector<double> primal_objs;
-	double dual_obj;
 	double bound;
+	bool has_candidates;
 
+	std::shared_ptr<const csenum_primal_data> primal;
+	std::shared_ptr<const csenum_dual_data> dual;
+
+	// Materialized
+	std::vector<double> primal_objs;
 	std::vector<std::vector<int>> arcs;
-	std::vector<cost_type> tolls;
-	std::vector<std::vector<bool>> slack_map;
-	std::vector<csenum_coor> candidates;
+
+	csenum_node() : bound(0), has_candidates(false), candidates_ready(false) {}
+
+	void materialize(int K);
+
+	// Node reloaded from a spilled queue, only the lineage and the bound are known (rebuilt in enter_node)
+	void restore(double _bound);
+	bool is_restored() const { return primal == nullptr; }
 
 	// Inherited via bb_node
 	virtual csenum_node* clone() const override;
 	virtual double get_bound() const override;
 	virtual const std::vector<csenum_coor>& get_candidates() const override;
+	virtual bool is_solution() const override;
+	virtual size_t get_memory_usage() const override;
+
+private:
+	mutable std::vector<csenum_coor> candidates;
+	mutable bool candidates_ready;
 };
@@ -7,6 +7,11 @@ csenum_solver::csenum_solver(const IloEnv& _env, const problem& _prob) :
 	build_primal_model();
 }
 
+csenum_solver_base* csenum_solver::clone(const IloEnv& env) const
+{
+	return new csenum_solver(env, prob);
+}
+
 void csenum_solver::build_primal_model()
 {
 	LOOP(k, K) primal_lgraphs.emplace_back(prob.graph);
@@ -14,7 +19,7 @@ void csenum_solver::build_primal_model()
 
 bool csenum_solver::solve_primal(int k)
 {
-	commodity& comm = prob.commodities[k];
+	const commodity& comm = prob.commodities[k];
 	primal_results[k] = primal_lgraphs[k].shortest_path(comm.origin, comm.destination);
 	return !primal_results[k].empty();
 }
@@ -39,9 +44,9 @@ double csenum_solver::get_primal_cost(int k)
 void csenum_solver::clear_primal_state_impl()
 {
 	// Enable all edges in primal graph
-	LOOP(k, K) LOOP(i, V) {
-		for (auto& pair : primal_lgraphs[k].E[i]) {
-			primal_lgraphs[k].Eall[pair.second].enabled = true;
+	LOOP(k, K) {
+		for (auto& edge : primal_lgraphs[k].Eall) {
+			edge.enabled = true;
 		}
 	}
 }
@@ -10,6 +10,8 @@ struct csenum_solver : public csenum_solver_dual_only
 
 	csenum_solver(const IloEnv& env, const problem& prob);
 
+	virtual csenum_solver_base* clone(const IloEnv& env) const override;
+
 	// Models
 	void build_primal_model();
 
@@ -12,6 +12,10 @@ struct csenum_solver_base : public model_single, public cplex_def
 	std::vector<csenum_coor> dual_state_stack;
 
 	csenum_solver_base(const IloEnv& env, const problem& prob);
+	virtual ~csenum_solver_base() {}
+
+	// Fresh solver of the same problem in another environment (for parallel workers)
+	virtual csenum_solver_base* clone(const IloEnv& env) const = 0;
 
 	virtual bool solve_primal(int k) = 0;
 	virtual std::vector<int> get_primal_arcs(int k) = 0;
@@ -16,7 +16,7 @@ void csenum_solver_dual_only::build_dual_model()
 
 	dual_obj = IloMaximize(env);
 	LOOP(k, K) {
-		commodity& comm = prob.commodities[k];
+		const commodity& comm = prob.commodities[k];
 		dual_obj.setLinearCoef(lambda[k][comm.origin], comm.demand);
 		dual_obj.setLinearCoef(lambda[k][comm.destination], -comm.demand);
 	}
@@ -8,6 +8,11 @@ csenum_solver_excl::csenum_solver_excl(const IloEnv& _env, const problem& _prob)
 	build_primal_model();
 }
 
+csenum_solver_base* csenum_solver_excl::clone(const IloEnv& env) const
+{
+	return new csenum_solver_excl(env, prob);
+}
+
 void csenum_solver_excl::build_primal_model()
 {
 	LOOP(k, K) {
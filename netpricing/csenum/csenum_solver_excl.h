@@ -17,6 +17,8 @@ struct csenum_solver_excl : public csenum_solver_dual_only
 
 	csenum_solver_excl(const IloEnv& env, const problem& prob);
 
+	virtual csenum_solver_base* clone(const IloEnv& env) const override;
+
 	// Models
 	void build_primal_model();
 
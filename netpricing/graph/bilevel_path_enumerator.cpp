@@ -0,0 +1,218 @@
+#include "bilevel_path_enumerator.h"
+
+#include "../macros.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <cassert>
+
+using namespace std;
+
+using path = bilevel_path_enumerator::path;
+using iipair = bilevel_path_enumerator::iipair;
+using toll_list = light_graph::toll_list;
+
+// Approximate heap memory held by a candidate
+static size_t entry_memory(const bilevel_path_enumerator::entry* e)
+{
+	return sizeof(*e) + e->path.capacity() * sizeof(int) + e->removed.capacity() * sizeof(iipair);
+}
+
+bilevel_path_enumerator::bilevel_path_enumerator(light_graph& graph, int from, int to, bool filter) :
+	graph(graph), from(from), to(to), filter(filter),
+	pending(nullptr), num_paths(0), memory(0), time(0), done(false)
+{
+	graph.clear_temp_states();
+
+	// First shortest path
+	path first_path = graph.shortest_path(from, to);
+
+	// Disconnected
+	if (first_path.empty()) {
+		done = true;
+		return;
+	}
+
+	cost_type cost = graph.get_path_cost(first_path);
+	push(new entry{
+		.path = std::move(first_path),
+		.cost = cost,
+		.spur_node = from,
+		.removed = vector<iipair>() });
+}
+
+bilevel_path_enumerator::~bilevel_path_enumerator()
+{
+	delete pending;
+	while (!B.empty())
+		delete pop();
+}
+
+void bilevel_path_enumerator::push(entry* e)
+{
+	memory += entry_memory(e);
+	B.push(e);
+}
+
+bilevel_path_enumerator::entry* bilevel_path_enumerator::pop()
+{
+	entry* e = B.top();
+	B.pop();
+	memory -= entry_memory(e);
+	return e;
+}
+
+bool bilevel_path_enumerator::next(path& p)
+{
+	auto start = chrono::high_resolution_clock::now();
+	bool found = false;
+
+	// Generate the subproblems of the last returned path
+	if (pending != nullptr) {
+		expand(pending);
+		delete pending;
+		pending = nullptr;
+	}
+
+	while (!done && !found) {
+		if (B.empty()) {
+			done = true;
+			break;
+		}
+
+		// Get the best candidate path
+		entry* last_entry = pop();
+
+		// Check if it is superset of any previous set
+		if (filter) {
+			toll_bitset tset = graph.get_toll_bitset(last_entry->path);
+			found = !visited_sets.has_subset_of(tset);
+			if (found)
+				visited_sets.insert(std::move(tset));
+		}
+		else
+			found = true;
+
+		if (found) {
+			p = last_entry->path;
+			num_paths++;
+		}
+
+		// The last path is toll-free path, stop
+		if (graph.is_toll_free(last_entry->path)) {
+			done = true;
+			delete last_entry;
+		}
+		// Returned paths are expanded lazily
+		else if (found)
+			pending = last_entry;
+		else {
+			expand(last_entry);
+			delete last_entry;
+		}
+	}
+
+	auto end = chrono::high_resolution_clock::now();
+	time += chrono::duration<double>(end - start).count();
+
+	return found;
+}
+
+vector<path> bilevel_path_enumerator::take(const budget& limits)
+{
+	vector<path> paths;
+	path p;
+
+	while ((limits.max_paths <= 0 || (int)paths.size() < limits.max_paths) &&
+		   (limits.time_limit <= 0 || time < limits.time_limit) &&
+		   (limits.max_memory <= 0 || memory <= limits.max_memory) &&
+		   next(p))
+		paths.push_back(std::move(p));
+
+	return paths;
+}
+
+void bilevel_path_enumerator::expand(const entry* e)
+{
+	const path& last_path = e->path;
+	int last_spur_node = e->spur_node;
+	const auto& last_removed = e->removed;
+
+	auto last_tlist = graph.get_toll_list(last_path);
+
+	// Find the first toll arcs succeeding spur_node
+	toll_list::iterator it;
+	if (last_spur_node == from)
+		it = last_tlist.begin();
+	else {
+		it = std::find_if(last_tlist.begin(), last_tlist.end(),
+						  [&](const auto& pair) {
+							  return pair.second == last_spur_node;
+						  });
+		assert(it != last_tlist.end()); // This iterator must exist
+		it++;
+	}
+
+	int spur_node = last_spur_node;
+	cost_type upper_bound = numeric_limits<cost_type>::infinity();
+
+	// Arcs removed by the parent stay disabled for all subproblems
+	for (auto& pair : last_removed)
+		graph.disable_temp_arc(pair);
+	int removed_mark = graph.temp_disabled_arcs.size();
+
+	// Nodes of the root path already disabled
+	auto blocked_it = last_path.begin();
+
+	// Generate subproblems
+	for (; it != last_tlist.end(); it++) {
+		vector<iipair> curr_removed = last_removed;
+		curr_removed.push_back(*it);
+
+		// Copy the subpath, spur nodes advance along the path
+		path curr_path;
+		auto spur_it = blocked_it;
+		if (spur_node != from) {
+			spur_it = std::find(blocked_it, last_path.end(), spur_node);
+			curr_path = vector<int>(last_path.begin(), spur_it);
+		}
+
+		// Disable the new arc and the new nodes of the root path
+		graph.disable_temp_arc(*it);
+
+		for (; blocked_it != spur_it; ++blocked_it)
+			graph.disable_temp_node(*blocked_it);
+
+		// Find the second segment
+		path spur_path = graph.shortest_path(spur_node, to);
+		graph.spur_count++;
+		if (!spur_path.empty()) {
+			curr_path.insert(curr_path.end(), spur_path.begin(), spur_path.end());
+			cost_type path_cost = graph.get_path_cost(curr_path);
+
+			// Check upper bound, only add if smaller
+			if (path_cost < upper_bound) {
+				push(new entry{
+					.path = std::move(curr_path),
+					.cost = path_cost,
+					.spur_node = spur_node,
+					.removed = std::move(curr_removed) });
+
+				// If the spur path is toll-free, set it as the new upper bound
+				if (graph.is_toll_free(spur_path)) {
+					upper_bound = path_cost;
+				}
+			}
+		}
+
+		// Restore the arc of this subproblem
+		graph.restore_temp_arcs(removed_mark);
+
+		// Set the next spur node
+		spur_node = it->second;
+	}
+
+	// Restore the parent state
+	graph.clear_temp_states();
+}
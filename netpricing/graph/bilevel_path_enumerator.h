@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <cstddef>
+
+#include "light_graph.h"
+
+// Resumable enumeration of bilevel feasible paths (the algorithm of light_graph::bilevel_feasible_paths_2)
+// Paths are pulled one at a time and the search state is kept between pulls,
+// so a caller can stop at a budget and ask for more paths later.
+// The graph must outlive the enumerator, its temporary states are clean between pulls.
+struct bilevel_path_enumerator
+{
+	using path = light_graph::path;
+	using iipair = light_graph::iipair;
+
+	struct entry {
+		std::vector<int> path;
+		cost_type cost;
+		int spur_node;
+		std::vector<iipair> removed;
+	};
+	struct entry_compare {
+		bool operator()(const entry* a, const entry* b) const {
+			// Reverse the order, smaller is better
+			return a->cost > b->cost;
+		}
+	};
+
+	// Limits of a pull (0 = no limit)
+	// The time limit applies to the total time spent by the enumerator, the memory limit to the candidate heap
+	struct budget {
+		int max_paths;
+		double time_limit;
+		size_t max_memory;
+	};
+
+	light_graph& graph;
+	int from, to;
+	bool filter;
+
+	std::priority_queue<entry*, std::vector<entry*>, entry_compare> B;
+	toll_set_index visited_sets;
+
+	// Last returned entry, its subproblems are generated on the next pull
+	entry* pending;
+
+	int num_paths;
+	size_t memory;
+	double time;
+	bool done;
+
+	bilevel_path_enumerator(light_graph& graph, int from, int to, bool filter = true);
+	~bilevel_path_enumerator();
+
+	bilevel_path_enumerator(const bilevel_path_enumerator&) = delete;
+	bilevel_path_enumerator& operator=(const bilevel_path_enumerator&) = delete;
+
+	// Next path (false if there is none left)
+	bool next(path& p);
+
+	// Pull paths until the budget is reached or the enumeration is exhausted
+	std::vector<path> take(const budget& limits);
+	std::vector<path> take(int max_paths) { return take(budget{ max_paths, 0, 0 }); }
+
+	bool exhausted() const { return done; }
+
+private:
+	void push(entry* e);
+	entry* pop();
+	void expand(const entry* e);
+};
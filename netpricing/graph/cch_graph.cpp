@@ -0,0 +1,446 @@
+#include "cch_graph.h"
+
+#include "../macros.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <set>
+
+using namespace std;
+
+using path = cch_graph::path;
+
+cch_graph::cch_graph(const light_graph& graph) :
+	V(graph.V), num_arcs(graph.Eall.size()), generation(0),
+	order_time(0), contract_time(0)
+{
+	auto start = chrono::high_resolution_clock::now();
+	compute_order(graph);
+	auto mid = chrono::high_resolution_clock::now();
+	contract(graph);
+	auto end = chrono::high_resolution_clock::now();
+
+	order_time = chrono::duration<double>(mid - start).count();
+	contract_time = chrono::duration<double>(end - mid).count();
+
+	fdist.resize(V);
+	bdist.resize(V);
+	fpred.resize(V);
+	bpred.resize(V);
+	fstamp.resize(V, 0);
+}
+
+// Recursive nested dissection with BFS level separators
+struct nested_dissection {
+	const vector<vector<int>>& adj;
+	vector<int>& order;
+	vector<int> mark;
+	vector<int> level;
+	int counter;
+
+	nested_dissection(const vector<vector<int>>& adj, vector<int>& order) :
+		adj(adj), order(order), mark(adj.size(), 0), level(adj.size(), -1), counter(0) {}
+
+	// BFS inside the current set (nodes marked with id), return the visited nodes in BFS order
+	vector<int> bfs(int root, int id) {
+		vector<int> visited{ root };
+		level[root] = 0;
+		mark[root] = -id;
+		for (size_t i = 0; i < visited.size(); i++) {
+			int u = visited[i];
+			for (int v : adj[u]) {
+				if (mark[v] != id)
+					continue;
+				mark[v] = -id;
+				level[v] = level[u] + 1;
+				visited.push_back(v);
+			}
+		}
+
+		// Restore the set mark
+		for (int v : visited) mark[v] = id;
+		return visited;
+	}
+
+	void leaf(vector<int>& nodes, int id) {
+		// Order by degree inside the subgraph
+		vector<pair<int, int>> degrees;
+		for (int u : nodes) {
+			int deg = count_if(adj[u].begin(), adj[u].end(), [&](int v) { return mark[v] == id; });
+			degrees.emplace_back(deg, u);
+		}
+		sort(degrees.begin(), degrees.end());
+		for (auto& d : degrees) order.push_back(d.second);
+	}
+
+	void dissect(vector<int> nodes) {
+		if (nodes.empty())
+			return;
+
+		int id = ++counter;
+		for (int u : nodes) mark[u] = id;
+
+		if ((int)nodes.size() <= cch_graph::DISSECTION_LEAF_SIZE) {
+			leaf(nodes, id);
+			return;
+		}
+
+		// Find a pseudo-peripheral node, then take the levels from it
+		vector<int> visited = bfs(nodes[0], id);
+		visited = bfs(visited.back(), id);
+
+		// Disconnected: dissect the components separately
+		if (visited.size() < nodes.size()) {
+			int cid = ++counter;
+			for (int u : visited) mark[u] = cid;
+			vector<int> rest;
+			for (int u : nodes)
+				if (mark[u] != cid) rest.push_back(u);
+			dissect(std::move(visited));
+			dissect(std::move(rest));
+			return;
+		}
+
+		// Separator is the level containing the median node
+		int sep_level = level[visited[visited.size() / 2]];
+
+		vector<int> part1, part2, separator;
+		for (int u : visited) {
+			if (level[u] < sep_level) part1.push_back(u);
+			else if (level[u] > sep_level) part2.push_back(u);
+			else separator.push_back(u);
+		}
+
+		dissect(std::move(part1));
+		dissect(std::move(part2));
+
+		// Separator nodes get the highest ranks
+		order.insert(order.end(), separator.begin(), separator.end());
+	}
+};
+
+void cch_graph::compute_order(const light_graph& graph)
+{
+	// Undirected adjacency
+	vector<vector<int>> adj(V);
+	LOOP(u, V) {
+		for (int s = graph.E.begin(u); s < graph.E.end(u); s++)
+			adj[u].push_back(graph.E.nodes[s]);
+		for (int s = graph.Er.begin(u); s < graph.Er.end(u); s++)
+			adj[u].push_back(graph.Er.nodes[s]);
+		sort(adj[u].begin(), adj[u].end());
+		adj[u].erase(unique(adj[u].begin(), adj[u].end()), adj[u].end());
+		adj[u].erase(remove(adj[u].begin(), adj[u].end(), u), adj[u].end());
+	}
+
+	vector<int> all(V);
+	LOOP(i, V) all[i] = i;
+
+	order.clear();
+	nested_dissection nd(adj, order);
+	nd.dissect(std::move(all));
+
+	rank.assign(V, -1);
+	LOOP(r, V) rank[order[r]] = r;
+}
+
+void cch_graph::contract(const light_graph& graph)
+{
+	// Undirected neighbors in the current (partially contracted) graph
+	vector<set<int>> nbrs(V);
+	for (const light_edge& e : graph.Eall) {
+		if (e.src == e.dst) continue;
+		nbrs[e.src].insert(e.dst);
+		nbrs[e.dst].insert(e.src);
+	}
+
+	auto by_rank = [&](int a, int b) { return rank[a] < rank[b]; };
+
+	// Eliminate nodes by rank, the upward neighbors of each node become a clique
+	vector<vector<int>> up(V);
+	for (int x : order) {
+		for (int y : nbrs[x])
+			if (rank[y] > rank[x])
+				up[x].push_back(y);
+		sort(up[x].begin(), up[x].end(), by_rank);
+
+		for (size_t i = 0; i < up[x].size(); i++) {
+			for (size_t j = i + 1; j < up[x].size(); j++) {
+				nbrs[up[x][i]].insert(up[x][j]);
+				nbrs[up[x][j]].insert(up[x][i]);
+			}
+		}
+		nbrs[x].clear();
+	}
+
+	// Edges and upward CSR, edge ids follow the rank of the lower node
+	vector<int> first_edge(V);
+	edge_lo.clear();
+	edge_hi.clear();
+	for (int x : order) {
+		first_edge[x] = edge_lo.size();
+		for (int y : up[x]) {
+			edge_lo.push_back(x);
+			edge_hi.push_back(y);
+		}
+	}
+
+	up_offsets.assign(V + 1, 0);
+	up_nodes.clear();
+	up_edges.clear();
+	elim_parent.assign(V, -1);
+	LOOP(x, V) {
+		up_offsets[x + 1] = up_offsets[x] + up[x].size();
+		LOOP(i, (int)up[x].size()) {
+			up_nodes.push_back(up[x][i]);
+			up_edges.push_back(first_edge[x] + i);
+		}
+		if (!up[x].empty())
+			elim_parent[x] = up[x][0];
+	}
+
+	int num_edges = edge_lo.size();
+
+	// Lower triangles
+	vector<vector<iipair>> tris(num_edges);
+	LOOP(x, V) {
+		LOOP(i, (int)up[x].size()) {
+			for (int j = i + 1; j < (int)up[x].size(); j++) {
+				int e = find_edge(up[x][i], up[x][j]);
+				tris[e].emplace_back(first_edge[x] + i, first_edge[x] + j);
+			}
+		}
+	}
+
+	tri_offsets.assign(num_edges + 1, 0);
+	triangles.clear();
+	LOOP(e, num_edges) {
+		tri_offsets[e + 1] = tri_offsets[e] + tris[e].size();
+		triangles.insert(triangles.end(), tris[e].begin(), tris[e].end());
+	}
+
+	// Map original arcs (parallel arcs ignored by light_graph are not mapped)
+	arc_edge.assign(num_arcs, -1);
+	arc_upward.assign(num_arcs, false);
+	LOOP(u, V) {
+		for (int s = graph.E.begin(u); s < graph.E.end(u); s++) {
+			int v = graph.E.nodes[s];
+			if (u == v) continue;
+			int a = graph.E.arcs[s];
+			arc_edge[a] = find_edge(u, v);
+			arc_upward[a] = rank[u] < rank[v];
+		}
+	}
+
+	const cost_type infinity = numeric_limits<cost_type>::infinity();
+	input_up.assign(num_edges, infinity);
+	input_down.assign(num_edges, infinity);
+	up_weight.assign(num_edges, infinity);
+	down_weight.assign(num_edges, infinity);
+	up_middle.assign(num_edges, -1);
+	down_middle.assign(num_edges, -1);
+}
+
+int cch_graph::find_edge(int u, int v) const
+{
+	if (rank[u] > rank[v])
+		std::swap(u, v);
+
+	auto first = up_nodes.begin() + up_offsets[u];
+	auto last = up_nodes.begin() + up_offsets[u + 1];
+	auto it = std::lower_bound(first, last, v,
+							   [&](int a, int b) { return rank[a] < rank[b]; });
+
+	return (it != last && *it == v) ? up_edges[it - up_nodes.begin()] : -1;
+}
+
+void cch_graph::customize(const std::vector<cost_type>& arc_weights)
+{
+	const cost_type infinity = numeric_limits<cost_type>::infinity();
+	fill(input_up.begin(), input_up.end(), infinity);
+	fill(input_down.begin(), input_down.end(), infinity);
+
+	LOOP(a, num_arcs) {
+		int e = arc_edge[a];
+		if (e < 0) continue;
+		(arc_upward[a] ? input_up : input_down)[e] = arc_weights[a];
+	}
+
+	// Lower triangles of an edge always have smaller ids
+	LOOP(e, (int)edge_lo.size())
+		recompute(e);
+}
+
+int cch_graph::update(const std::vector<std::pair<int, cost_type>>& changed_arcs)
+{
+	std::priority_queue<int, vector<int>, std::greater<int>> queue;
+	vector<bool> queued(edge_lo.size(), false);
+
+	for (const auto& pair : changed_arcs) {
+		int e = arc_edge[pair.first];
+		if (e < 0) continue;
+
+		(arc_upward[pair.first] ? input_up : input_down)[e] = pair.second;
+		if (!queued[e]) {
+			queued[e] = true;
+			queue.push(e);
+		}
+	}
+
+	// Propagate to the edges whose lower triangles contain a changed edge
+	int count = 0;
+	while (!queue.empty()) {
+		int e = queue.top();
+		queue.pop();
+		count++;
+
+		if (!recompute(e))
+			continue;
+
+		int x = edge_lo[e], y = edge_hi[e];
+		for (int s = up_offsets[x]; s < up_offsets[x + 1]; s++) {
+			int z = up_nodes[s];
+			if (z == y) continue;
+
+			int d = find_edge(y, z);
+			if (!queued[d]) {
+				queued[d] = true;
+				queue.push(d);
+			}
+		}
+	}
+
+	return count;
+}
+
+bool cch_graph::recompute(int e)
+{
+	cost_type up = input_up[e], down = input_down[e];
+	int um = -1, dm = -1;
+
+	for (int t = tri_offsets[e]; t < tri_offsets[e + 1]; t++) {
+		// e1 = {x, lo}, e2 = {x, hi}, x is the lowest node of the triangle
+		int e1 = triangles[t].first, e2 = triangles[t].second;
+		int x = edge_lo[e1];
+
+		// lo -> x -> hi
+		cost_type c = down_weight[e1] + up_weight[e2];
+		if (c < up) {
+			up = c;
+			um = x;
+		}
+
+		// hi -> x -> lo
+		c = down_weight[e2] + up_weight[e1];
+		if (c < down) {
+			down = c;
+			dm = x;
+		}
+	}
+
+	bool changed = up != up_weight[e] || down != down_weight[e];
+
+	up_weight[e] = up;
+	down_weight[e] = down;
+	up_middle[e] = um;
+	down_middle[e] = dm;
+
+	return changed;
+}
+
+path cch_graph::shortest_path(int from, int to)
+{
+	const cost_type infinity = numeric_limits<cost_type>::infinity();
+
+	if (++generation == 0) {
+		fill(fstamp.begin(), fstamp.end(), 0);
+		generation = 1;
+	}
+
+	// Forward search along the elimination tree ancestors of "from"
+	for (int v = from; v != -1; v = elim_parent[v]) {
+		fdist[v] = infinity;
+		fpred[v] = -1;
+		fstamp[v] = generation;
+	}
+	fdist[from] = 0;
+
+	for (int v = from; v != -1; v = elim_parent[v]) {
+		if (fdist[v] == infinity) continue;
+		for (int s = up_offsets[v]; s < up_offsets[v + 1]; s++) {
+			int w = up_nodes[s];
+			cost_type c = fdist[v] + up_weight[up_edges[s]];
+			if (c < fdist[w]) {
+				fdist[w] = c;
+				fpred[w] = v;
+			}
+		}
+	}
+
+	// Backward search along the ancestors of "to"
+	for (int v = to; v != -1; v = elim_parent[v]) {
+		bdist[v] = infinity;
+		bpred[v] = -1;
+	}
+	bdist[to] = 0;
+
+	int meet = -1;
+	cost_type best = infinity;
+
+	for (int v = to; v != -1; v = elim_parent[v]) {
+		if (bdist[v] == infinity) continue;
+
+		// Common ancestor
+		if (fstamp[v] == generation && fdist[v] + bdist[v] < best) {
+			best = fdist[v] + bdist[v];
+			meet = v;
+		}
+
+		for (int s = up_offsets[v]; s < up_offsets[v + 1]; s++) {
+			int w = up_nodes[s];
+			cost_type c = bdist[v] + down_weight[up_edges[s]];
+			if (c < bdist[w]) {
+				bdist[w] = c;
+				bpred[w] = v;
+			}
+		}
+	}
+
+	if (meet < 0)
+		return path();
+
+	// Upward part from "from" to meet
+	vector<int> chain;
+	for (int v = meet; v != from; v = fpred[v])
+		chain.push_back(v);
+	chain.push_back(from);
+	std::reverse(chain.begin(), chain.end());
+
+	path p{ from };
+	for (int i = 0; i < (int)chain.size() - 1; i++)
+		unpack(chain[i], chain[i + 1], p);
+
+	// Downward part from meet to "to"
+	for (int v = meet; v != to; v = bpred[v])
+		unpack(v, bpred[v], p);
+
+	return p;
+}
+
+void cch_graph::unpack(int from, int to, path& p) const
+{
+	int e = find_edge(from, to);
+	int middle = (rank[from] < rank[to]) ? up_middle[e] : down_middle[e];
+
+	// Original arc
+	if (middle < 0) {
+		p.push_back(to);
+		return;
+	}
+
+	unpack(from, middle, p);
+	unpack(middle, to, p);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "light_graph.h"
+
+// Customizable Contraction Hierarchy
+// The topology (ordering, shortcuts, triangles) is computed once,
+// the metric (arc weights) can then be customized many times
+struct cch_graph
+{
+	using path = std::vector<int>;
+	using iipair = std::pair<int, int>;
+
+	// Subgraphs smaller than this are ordered by minimum degree instead of being dissected
+	constexpr static int DISSECTION_LEAF_SIZE = 16;
+
+	int V;
+	int num_arcs;
+
+	// Nested dissection ordering (order[r] is the node of rank r)
+	std::vector<int> order;
+	std::vector<int> rank;
+
+	// Upward adjacency in CSR, neighbors sorted by rank
+	std::vector<int> up_offsets;
+	std::vector<int> up_nodes;
+	std::vector<int> up_edges;
+
+	// Elimination tree (parent = lowest ranked upward neighbor, -1 for roots)
+	std::vector<int> elim_parent;
+
+	// Undirected CCH edges {lo, hi} with rank[lo] < rank[hi], ids are sorted by rank[lo]
+	std::vector<int> edge_lo;
+	std::vector<int> edge_hi;
+
+	// Directed metric: up = lo -> hi, down = hi -> lo
+	// Middle node of the lower triangle giving the weight, -1 if the weight comes from an original arc
+	std::vector<cost_type> input_up, input_down;
+	std::vector<cost_type> up_weight, down_weight;
+	std::vector<int> up_middle, down_middle;
+
+	// Lower triangles of each edge: pairs of edges ({x, lo}, {x, hi})
+	std::vector<int> tri_offsets;
+	std::vector<iipair> triangles;
+
+	// Original arc (light_graph arc index) to CCH edge and direction
+	std::vector<int> arc_edge;
+	std::vector<bool> arc_upward;
+
+	// Query workspace
+	std::vector<cost_type> fdist, bdist;
+	std::vector<int> fpred, bpred;
+	std::vector<int> fstamp;
+	int generation;
+
+	// Preprocessing statistics
+	double order_time;
+	double contract_time;
+
+	cch_graph(const light_graph& graph);
+
+	// Metric-independent preprocessing
+	void compute_order(const light_graph& graph);
+	void contract(const light_graph& graph);
+
+	int find_edge(int u, int v) const;
+
+	// Customization
+	void customize(const std::vector<cost_type>& arc_weights);
+	int update(const std::vector<std::pair<int, cost_type>>& changed_arcs);
+	bool recompute(int e);
+
+	// Query
+	path shortest_path(int from, int to);
+	void unpack(int from, int to, path& p) const;
+};
@@ -88,12 +88,12 @@ void cplex_graph::reset()
 
 void cplex_graph::force(int src, int dst)
 {
-	x[E[src].at(dst)].setBounds(1, 1);
+	x[arc_index(src, dst)].setBounds(1, 1);
 }
 
 void cplex_graph::disable(int src, int dst)
 {
-	x[E[src].at(dst)].setBounds(0, 0);
+	x[arc_index(src, dst)].setBounds(0, 0);
 }
 
 struct bfpath3_entry {
@@ -119,7 +119,7 @@ vector<path> cplex_graph::bilevel_feasible_paths_3(int from, int to, int K, bool
 	// Heap of candidates B
 	std::priority_queue<bfpath3_entry*, vector<bfpath3_entry*>, bfpath3_compare> B;
 
-	vector<toll_set> visited_sets;
+	toll_set_index visited_sets;
 
 	// First shortest path
 	path first_path = shortest_path(from, to);
@@ -148,15 +148,12 @@ vector<path> cplex_graph::bilevel_feasible_paths_3(int from, int to, int K, bool
 
 		if (filter) {
 			// Check if it is superset of any previous set
-			toll_set tset = get_toll_set(last_path);
-			bool dominated = std::any_of(visited_sets.begin(), visited_sets.end(),
-										 [&](const auto& s) {
-											 return std::includes(tset.begin(), tset.end(), s.begin(), s.end());
-										 });
+			toll_bitset tset = get_toll_bitset(last_path);
+			bool dominated = visited_sets.has_subset_of(tset);
 		   // Add to output if not dominated
 			if (!dominated) {
 				A.push_back(last_path);
-				visited_sets.emplace_back(std::move(tset));
+				visited_sets.insert(std::move(tset));
 			}
 		}
 		else
@@ -3,10 +3,13 @@
 #include "../macros.h"
 
 #include <algorithm>
+#include <functional>
 #include <queue>
 #include <tuple>
 #include <set>
 #include <iostream>
+#include <stdexcept>
+#include <cmath>
 
 using namespace std;
 
@@ -16,13 +19,21 @@ using toll_set = light_graph::toll_set;
 using toll_list = light_graph::toll_list;
 
 light_graph::light_graph(int V) :
-	V(V), Eall(), E(V), Er(V),
-	temp_enabled_V(V, true)
-{}
+	V(V), Eall(), E(), Er(),
+	temp_enabled_V(V, true), toll_index_size(0),
+	spur_count(0), temp_restore_count(0),
+	heap(BINARY_HEAP), radix_scale(DEFAULT_RADIX_SCALE),
+	search(UNIDIRECTIONAL)
+{
+	build_adjacency();
+}
 
 light_graph::light_graph(const problem_base::graph_type& graph) :
-	V(boost::num_vertices(graph)), Eall(), E(V), Er(V),
-	temp_enabled_V(V, true)
+	V(boost::num_vertices(graph)), Eall(), E(), Er(),
+	temp_enabled_V(V, true), toll_index_size(0),
+	spur_count(0), temp_restore_count(0),
+	heap(BINARY_HEAP), radix_scale(DEFAULT_RADIX_SCALE),
+	search(UNIDIRECTIONAL)
 {
 	auto cost_map = boost::get(boost::edge_weight, graph);
 	auto is_tolled_map = boost::get(edge_tolled, graph);
@@ -49,13 +60,112 @@ light_graph::light_graph(const problem_base::graph_type& graph) :
 							   });
 	}
 
-	LOOP(a, Eall.size()) {
-		auto& edge = Eall[a];
-		E[edge.src].emplace(edge.dst, a);
-		Er[edge.dst].emplace(edge.src, a);
+	build_adjacency();
+}
+
+toll_bitset::toll_bitset(int size) :
+	words((size + 63) / 64, 0), signature(0), count(0)
+{
+}
+
+void toll_bitset::insert(int index)
+{
+	uint64_t bit = uint64_t(1) << (index % 64);
+	uint64_t& word = words[index / 64];
+	if (!(word & bit)) {
+		word |= bit;
+		signature |= bit;
+		count++;
 	}
 }
 
+bool toll_bitset::includes(const toll_bitset& other) const
+{
+	// No early exit, so the loop is vectorized
+	uint64_t missing = 0;
+	for (size_t i = 0; i < words.size(); i++)
+		missing |= other.words[i] & ~words[i];
+	return missing == 0;
+}
+
+void toll_set_index::insert(toll_bitset set)
+{
+	signatures.push_back(set.signature);
+	counts.push_back(set.count);
+	sets.emplace_back(std::move(set));
+}
+
+bool toll_set_index::has_subset_of(const toll_bitset& set) const
+{
+	for (size_t i = 0; i < sets.size(); i++) {
+		if (counts[i] <= set.count && (signatures[i] & ~set.signature) == 0 && set.includes(sets[i]))
+			return true;
+	}
+	return false;
+}
+
+int light_adjacency::find(int i, int j) const
+{
+	auto first = nodes.begin() + offsets[i];
+	auto last = nodes.begin() + offsets[i + 1];
+	auto it = std::lower_bound(first, last, j);
+	return (it != last && *it == j) ? (int)(it - nodes.begin()) : -1;
+}
+
+// Fill a CSR adjacency from (row, col, arc) triples sorted by (row, col, arc)
+// Parallel arcs are dropped, only the one with the smallest index is kept
+static void fill_adjacency(light_adjacency& adj, int V, const vector<light_edge>& Eall,
+						   vector<tuple<int, int, int>>& triples)
+{
+	std::sort(triples.begin(), triples.end());
+	triples.erase(std::unique(triples.begin(), triples.end(),
+							  [](const auto& a, const auto& b) {
+								  return std::get<0>(a) == std::get<0>(b) && std::get<1>(a) == std::get<1>(b);
+							  }),
+				  triples.end());
+
+	adj.offsets.assign(V + 1, 0);
+	adj.nodes.clear();
+	adj.arcs.clear();
+	adj.costs.clear();
+	adj.nodes.reserve(triples.size());
+	adj.arcs.reserve(triples.size());
+	adj.costs.reserve(triples.size());
+
+	for (const auto& t : triples) {
+		int row, col, a;
+		tie(row, col, a) = t;
+		adj.offsets[row + 1]++;
+		adj.nodes.push_back(col);
+		adj.arcs.push_back(a);
+		adj.costs.push_back(Eall[a].cost);
+	}
+
+	LOOP(i, V) adj.offsets[i + 1] += adj.offsets[i];
+}
+
+void light_graph::build_adjacency()
+{
+	// Costs may have changed
+	potentials.clear();
+
+	vector<tuple<int, int, int>> triples;
+	triples.reserve(Eall.size());
+
+	LOOP(a, (int)Eall.size())
+		triples.emplace_back(Eall[a].src, Eall[a].dst, a);
+	fill_adjacency(E, V, Eall, triples);
+
+	triples.clear();
+	LOOP(a, (int)Eall.size())
+		triples.emplace_back(Eall[a].dst, Eall[a].src, a);
+	fill_adjacency(Er, V, Eall, triples);
+
+	toll_index_size = 0;
+	for (const auto& edge : Eall)
+		toll_index_size = max(toll_index_size, edge.index + 1);
+}
+
 int light_graph::num_tolled() const
 {
 	return std::count_if(Eall.begin(), Eall.end(),
@@ -64,24 +174,32 @@ int light_graph::num_tolled() const
 						 });
 }
 
+int light_graph::arc_index(int src, int dst) const
+{
+	int slot = E.find(src, dst);
+	if (slot < 0)
+		throw out_of_range("Light graph error: edge not found");
+	return E.arcs[slot];
+}
+
 light_edge& light_graph::edge(int src, int dst)
 {
-	return Eall[E[src].at(dst)];
+	return Eall[arc_index(src, dst)];
 }
 
 light_edge& light_graph::edge(const iipair& pair)
 {
-	return Eall[E[pair.first].at(pair.second)];
+	return Eall[arc_index(pair.first, pair.second)];
 }
 
 const light_edge& light_graph::edge(int src, int dst) const
 {
-	return Eall[E[src].at(dst)];
+	return Eall[arc_index(src, dst)];
 }
 
 const light_edge& light_graph::edge(const iipair& pair) const
 {
-	return Eall[E[pair.first].at(pair.second)];
+	return Eall[arc_index(pair.first, pair.second)];
 }
 
 void light_graph::set_toll_arcs_enabled(bool enabled)
@@ -102,22 +220,57 @@ void light_graph::clear_toll()
 
 light_graph::path light_graph::shortest_path(int from, int to)
 {
-	vector<int> parents;
-	vector<cost_type> distances;
+	// Fill the potential cache first, the search itself is const
+	if (search == ASTAR)
+		potential(to);
+
+	return shortest_path(light_workspace::local(), from, to);
+}
+
+light_graph::path light_graph::shortest_path(light_workspace& ws, int from, int to, const toll_overlay* tolls) const
+{
+	if (search == BIDIRECTIONAL) {
+		light_workspace& bws = light_workspace::local(1);
+		int meet;
+		if (!bidirectional_dijkstra(ws, bws, from, to, meet, tolls))
+			return path();
+
+		// Forward part up to the meeting node, then follow the backward tree
+		path p = trace_path(ws, from, meet);
+		for (int curr = meet; curr != to; ) {
+			curr = bws.parents[curr];
+			p.push_back(curr);
+		}
+		return p;
+	}
+
+	// Without a cached potential, A* falls back to Dijkstra
+	auto it = (search == ASTAR) ? potentials.find(to) : potentials.end();
 
 	// If "to" is not reached, return empty path
-	if (!dijkstra(from, distances, parents, to))
+	bool reached = (it != potentials.end()) ?
+		astar(ws, from, to, it->second, tolls) :
+		dijkstra(ws, from, to, false, tolls);
+	if (!reached)
 		return path();
 
-	// Trace back the path
-	path p;
+	return trace_path(ws, from, to);
+}
+
+light_graph::path light_graph::trace_path(const light_workspace& ws, int from, int to) const
+{
+	// Count the nodes first, then fill the path backward
+	int length = 1;
+	for (int curr = to; curr != from; curr = ws.parents[curr])
+		length++;
+
+	path p(length);
 	int curr = to;
-	while (curr != from) {
-		p.push_back(curr);
-		curr = parents[curr];
+	for (int i = length - 1; i > 0; i--) {
+		p[i] = curr;
+		curr = ws.parents[curr];
 	}
-	p.push_back(from);
-	std::reverse(p.begin(), p.end());
+	p[0] = from;
 
 	return p;
 }
@@ -147,6 +300,19 @@ cost_type light_graph::get_path_toll(const path& p) const
 	return sum;
 }
 
+cost_type light_graph::get_path_toll(const path& p, const toll_overlay& tolls) const
+{
+	cost_type sum = 0;
+
+	for (int i = 0; i < (int)p.size() - 1; i++) {
+		const auto& edge = this->edge(p[i], p[i + 1]);
+		if (edge.is_tolled)
+			sum += tolls[edge.index];
+	}
+
+	return sum;
+}
+
 toll_set light_graph::get_toll_set(const path& p) const
 {
 	toll_set toll_set;
@@ -165,6 +331,17 @@ toll_list light_graph::get_toll_list(const path& p) const
 	return toll_list;
 }
 
+toll_bitset light_graph::get_toll_bitset(const path& p) const
+{
+	toll_bitset tset(toll_index_size);
+	for (int i = 0; i < (int)p.size() - 1; i++) {
+		const auto& edge = this->edge(p[i], p[i + 1]);
+		if (edge.is_tolled)
+			tset.insert(edge.index);
+	}
+	return tset;
+}
+
 bool light_graph::is_toll_free(const path& p) const
 {
 	for (int i = 0; i < p.size() - 1; i++)
@@ -193,26 +370,148 @@ vector<cost_type> light_graph::price_to_dst(int dst) const
 	return distances;
 }
 
+light_radix_heap::light_radix_heap() :
+	last(0), count(0) {}
+
+void light_radix_heap::clear()
+{
+	for (auto& bucket : buckets)
+		bucket.clear();
+	last = 0;
+	count = 0;
+}
+
+static inline int radix_bucket(uint64_t key, uint64_t last)
+{
+	return key == last ? 0 : 64 - __builtin_clzll(key ^ last);
+}
+
+void light_radix_heap::push(uint64_t key, int v)
+{
+	buckets[radix_bucket(key, last)].emplace_back(key, v);
+	count++;
+}
+
+void light_radix_heap::pop()
+{
+	refill();
+	buckets[0].pop_back();
+	count--;
+}
+
+const light_radix_heap::entry& light_radix_heap::top()
+{
+	refill();
+	return buckets[0].back();
+}
+
+void light_radix_heap::refill()
+{
+	if (!buckets[0].empty())
+		return;
+
+	int i = 1;
+	while (buckets[i].empty())
+		i++;
+
+	// The new minimum becomes the reference key, every entry of bucket i moves to a lower bucket
+	last = std::min_element(buckets[i].begin(), buckets[i].end())->first;
+	for (const entry& e : buckets[i])
+		buckets[radix_bucket(e.first, last)].push_back(e);
+	buckets[i].clear();
+}
+
+light_workspace::light_workspace() :
+	generation(0) {}
+
+void light_workspace::reset(int V)
+{
+	if (reached.size() < (size_t)V) {
+		reached.resize(V, 0);
+		closed.resize(V, 0);
+		distances.resize(V);
+		parents.resize(V);
+		keys.resize(V);
+	}
+
+	// On overflow, clear all stamps
+	if (++generation == 0) {
+		fill(reached.begin(), reached.end(), 0);
+		fill(closed.begin(), closed.end(), 0);
+		generation = 1;
+	}
+
+	heap.clear();
+	radix.clear();
+}
+
+cost_type light_workspace::distance(int v) const
+{
+	return is_reached(v) ? distances[v] : numeric_limits<cost_type>::infinity();
+}
+
+void light_workspace::label(int v, cost_type dist, int parent)
+{
+	reached[v] = generation;
+	distances[v] = dist;
+	parents[v] = parent;
+}
+
+void light_workspace::push(cost_type dist, int v)
+{
+	heap.emplace_back(dist, v);
+	std::push_heap(heap.begin(), heap.end(), std::greater<cipair>());
+}
+
+void light_workspace::pop()
+{
+	std::pop_heap(heap.begin(), heap.end(), std::greater<cipair>());
+	heap.pop_back();
+}
+
+light_workspace& light_workspace::local(int slot)
+{
+	static thread_local light_workspace ws[2];
+	return ws[slot];
+}
+
 bool light_graph::dijkstra(int from, std::vector<cost_type>& distances, std::vector<int>& parents, int to, bool reversed) const
 {
-	using cipair = std::pair<cost_type, int>;
+	light_workspace& ws = light_workspace::local();
+	bool reached = dijkstra(ws, from, to, reversed);
+
+	// Export the labels
+	distances.resize(V);
+	parents.resize(V);
+	LOOP(i, V) {
+		distances[i] = ws.distance(i);
+		parents[i] = ws.parent(i);
+	}
+
+	return reached;
+}
 
-	const vector<map<int, int>>& Ec = reversed ? Er : E;
+bool light_graph::dijkstra(light_workspace& ws, int from, int to, bool reversed, const toll_overlay* tolls) const
+{
+	switch (heap) {
+	case RADIX_HEAP: return dijkstra_radix(ws, from, to, reversed, tolls);
+	default: return dijkstra_binary(ws, from, to, reversed, tolls);
+	}
+}
 
-	parents = std::move(vector<int>(V, -1));
-	distances = std::move(vector<cost_type>(V, numeric_limits<double>::infinity()));
-	vector<bool> closed(V, false);
+bool light_graph::dijkstra_binary(light_workspace& ws, int from, int to, bool reversed, const toll_overlay* tolls) const
+{
+	const light_adjacency& Ec = reversed ? Er : E;
 
-	std::priority_queue<cipair, vector<cipair>, std::greater<cipair>> queue;
+	ws.reset(V);
 
 	// First node
-	queue.push(make_pair(0, from));
-	distances[from] = 0;
-	parents[from] = from;
+	ws.push(0, from);
+	ws.label(from, 0, from);
 
 	// Until queue is empty
-	while (!queue.empty()) {
-		int src = queue.top().second;
+	while (!ws.empty()) {
+		int src = ws.top().second;
 
 		if (!temp_enabled_V[src])
 			throw logic_error("Light graph error: queued node must be enabled");
@@ -221,43 +520,288 @@ bool light_graph::dijkstra(int from, std::vector<cost_type>& distances, std::vec
 		if (src == to)
 			break;
 
-		queue.pop();
+		ws.pop();
 
 		// Already closed
-		if (closed[src])
+		if (ws.is_closed(src))
 			continue;
 
 		// Loop for each edge from curr
-		cost_type curr_dist = distances[src];
-		for (auto it = Ec[src].begin(); it != Ec[src].end(); ++it) {
+		cost_type curr_dist = ws.distances[src];
+		for (int s = Ec.begin(src), s_end = Ec.end(src); s < s_end; ++s) {
+			int dst = Ec.nodes[s];
+
 			// Skip disabled node
-			if (!temp_enabled_V[it->first])
+			if (!temp_enabled_V[dst])
 				continue;
 
-			const light_edge& edge = Eall[it->second];
+			const light_edge& edge = Eall[Ec.arcs[s]];
 
 			// Skip disabled edge
 			if (!edge.enabled || !edge.temp_enabled)
 				continue;
 
-			int dst = it->first;
-			cost_type new_dist = curr_dist + edge.cost + edge.toll;
+			cost_type new_dist = curr_dist + Ec.costs[s] + arc_toll(edge, tolls);
 
 			// New distance is better
-			if (new_dist < distances[dst]) {
-				distances[dst] = new_dist;
-				parents[dst] = src;
+			if (new_dist < ws.distance(dst)) {
+				ws.label(dst, new_dist, src);
 
 				// Add a new entry to the queue
-				queue.push(make_pair(new_dist, dst));
+				ws.push(new_dist, dst);
 			}
 		}
 
 		// Close the vertex
-		closed[src] = true;
+		ws.close(src);
 	}
 
 	// If there is no destination, always return true
 	// If the queue is empty, the destination was not reached, return false
-	return to < 0 || !queue.empty();
+	return to < 0 || !ws.empty();
+}
+
+bool light_graph::dijkstra_radix(light_workspace& ws, int from, int to, bool reversed, const toll_overlay* tolls) const
+{
+	const light_adjacency& Ec = reversed ? Er : E;
+
+	ws.reset(V);
+
+	// First node
+	ws.radix.push(0, from);
+	ws.keys[from] = 0;
+	ws.label(from, 0, from);
+
+	// Until queue is empty
+	while (!ws.radix.empty()) {
+		int src = ws.radix.top().second;
+
+		if (!temp_enabled_V[src])
+			throw logic_error("Light graph error: queued node must be enabled");
+
+		// Break if destination reached
+		if (src == to)
+			break;
+
+		ws.radix.pop();
+
+		// Already closed
+		if (ws.is_closed(src))
+			continue;
+
+		// Loop for each edge from curr
+		uint64_t curr_key = ws.keys[src];
+		for (int s = Ec.begin(src), s_end = Ec.end(src); s < s_end; ++s) {
+			int dst = Ec.nodes[s];
+
+			// Skip disabled node
+			if (!temp_enabled_V[dst])
+				continue;
+
+			const light_edge& edge = Eall[Ec.arcs[s]];
+
+			// Skip disabled edge
+			if (!edge.enabled || !edge.temp_enabled)
+				continue;
+
+			// Fixed-point weight, rounded to nearest (negative weights are clamped to 0)
+			double weight = (Ec.costs[s] + arc_toll(edge, tolls)) * radix_scale;
+			uint64_t new_key = curr_key + (weight > 0 ? (uint64_t)(weight + 0.5) : 0);
+
+			// New distance is better
+			if (!ws.is_reached(dst) || new_key < ws.keys[dst]) {
+				ws.keys[dst] = new_key;
+				ws.label(dst, new_key / radix_scale, src);
+
+				// Add a new entry to the queue
+				ws.radix.push(new_key, dst);
+			}
+		}
+
+		// Close the vertex
+		ws.close(src);
+	}
+
+	// If there is no destination, always return true
+	// If the queue is empty, the destination was not reached, return false
+	return to < 0 || !ws.radix.empty();
+}
+
+bool light_graph::bidirectional_dijkstra(light_workspace& fws, light_workspace& bws, int from, int to, int& meet,
+										 const toll_overlay* tolls) const
+{
+	fws.reset(V);
+	bws.reset(V);
+
+	// Disabled destination cannot be reached
+	if (!temp_enabled_V[to])
+		return false;
+
+	fws.push(0, from);
+	fws.label(from, 0, from);
+	bws.push(0, to);
+	bws.label(to, 0, to);
+
+	// Best path length found so far and its meeting node
+	cost_type best = (from == to) ? 0 : numeric_limits<cost_type>::infinity();
+	meet = (from == to) ? from : -1;
+
+	while (!fws.empty() && !bws.empty()) {
+		// No better meeting is possible
+		if (fws.top().first + bws.top().first >= best)
+			break;
+
+		// Expand the side with the smaller key
+		bool forward = fws.top().first <= bws.top().first;
+		light_workspace& ws = forward ? fws : bws;
+		light_workspace& other = forward ? bws : fws;
+		const light_adjacency& Ec = forward ? E : Er;
+
+		int src = ws.top().second;
+		ws.pop();
+
+		if (!temp_enabled_V[src])
+			throw logic_error("Light graph error: queued node must be enabled");
+
+		// Already closed
+		if (ws.is_closed(src))
+			continue;
+
+		cost_type curr_dist = ws.distances[src];
+		for (int s = Ec.begin(src), s_end = Ec.end(src); s < s_end; ++s) {
+			int dst = Ec.nodes[s];
+
+			// Skip disabled node
+			if (!temp_enabled_V[dst])
+				continue;
+
+			const light_edge& edge = Eall[Ec.arcs[s]];
+
+			// Skip disabled edge
+			if (!edge.enabled || !edge.temp_enabled)
+				continue;
+
+			cost_type new_dist = curr_dist + Ec.costs[s] + arc_toll(edge, tolls);
+
+			if (new_dist < ws.distance(dst)) {
+				ws.label(dst, new_dist, src);
+				ws.push(new_dist, dst);
+			}
+
+			// Check for a better meeting node
+			if (other.is_reached(dst)) {
+				cost_type total = ws.distances[dst] + other.distances[dst];
+				if (total < best) {
+					best = total;
+					meet = dst;
+				}
+			}
+		}
+
+		ws.close(src);
+	}
+
+	return meet >= 0;
+}
+
+bool light_graph::astar(light_workspace& ws, int from, int to, const std::vector<cost_type>& potential,
+						const toll_overlay* tolls) const
+{
+	const cost_type infinity = numeric_limits<cost_type>::infinity();
+
+	ws.reset(V);
+
+	// "to" cannot be reached even without tolls
+	if (potential[from] == infinity)
+		return false;
+
+	// Keys are distance + potential
+	ws.push(potential[from], from);
+	ws.label(from, 0, from);
+
+	while (!ws.empty()) {
+		int src = ws.top().second;
+
+		if (!temp_enabled_V[src])
+			throw logic_error("Light graph error: queued node must be enabled");
+
+		// Break if destination reached
+		if (src == to)
+			break;
+
+		ws.pop();
+
+		// Already closed
+		if (ws.is_closed(src))
+			continue;
+
+		cost_type curr_dist = ws.distances[src];
+		for (int s = E.begin(src), s_end = E.end(src); s < s_end; ++s) {
+			int dst = E.nodes[s];
+
+			// Skip disabled, closed or dead-end node
+			if (!temp_enabled_V[dst] || ws.is_closed(dst) || potential[dst] == infinity)
+				continue;
+
+			const light_edge& edge = Eall[E.arcs[s]];
+
+			// Skip disabled edge
+			if (!edge.enabled || !edge.temp_enabled)
+				continue;
+
+			cost_type new_dist = curr_dist + E.costs[s] + arc_toll(edge, tolls);
+
+			if (new_dist < ws.distance(dst)) {
+				ws.label(dst, new_dist, src);
+				ws.push(new_dist + potential[dst], dst);
+			}
+		}
+
+		ws.close(src);
+	}
+
+	return !ws.empty();
+}
+
+const std::vector<cost_type>& light_graph::potential(int dst)
+{
+	auto it = potentials.find(dst);
+	if (it == potentials.end())
+		it = potentials.emplace(dst, lower_bounds_to_dst(dst)).first;
+	return it->second;
+}
+
+std::vector<cost_type> light_graph::lower_bounds_to_dst(int dst) const
+{
+	light_workspace& ws = light_workspace::local();
+	ws.reset(V);
+
+	ws.push(0, dst);
+	ws.label(dst, 0, dst);
+
+	// Reverse Dijkstra on arc costs only, ignoring tolls and all enable flags
+	while (!ws.empty()) {
+		int src = ws.top().second;
+		ws.pop();
+
+		if (ws.is_closed(src))
+			continue;
+
+		cost_type curr_dist = ws.distances[src];
+		for (int s = Er.begin(src), s_end = Er.end(src); s < s_end; ++s) {
+			int next = Er.nodes[s];
+			cost_type new_dist = curr_dist + Er.costs[s];
+
+			if (new_dist < ws.distance(next)) {
+				ws.label(next, new_dist, src);
+				ws.push(new_dist, next);
+			}
+		}
+
+		ws.close(src);
+	}
+
+	vector<cost_type> bounds(V);
+	LOOP(i, V) bounds[i] = ws.distance(i);
+	return bounds;
 }
@@ -4,6 +4,8 @@
 #include <tuple>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <cstdint>
 
 #include "../typedef.h"
 #include "../problem_base.h"
@@ -20,6 +22,113 @@ struct light_edge
 	bool temp_enabled;
 };
 
+// Compressed sparse row adjacency (one direction)
+// Row i spans [offsets[i], offsets[i + 1]), sorted by neighbor
+struct light_adjacency
+{
+	std::vector<int> offsets;
+	std::vector<int> nodes;
+	std::vector<int> arcs;
+	std::vector<cost_type> costs;
+
+	int begin(int i) const { return offsets[i]; }
+	int end(int i) const { return offsets[i + 1]; }
+	int find(int i, int j) const;
+};
+
+// Set of tolled arcs as a dense bitset indexed by light_edge::index
+struct toll_bitset
+{
+	std::vector<uint64_t> words;
+	uint64_t signature;		// Indices folded modulo 64
+	int count;
+
+	toll_bitset(int size = 0);
+
+	void insert(int index);
+	bool empty() const { return count == 0; }
+
+	// True if all elements of other are in this set (both sets must have the same size)
+	bool includes(const toll_bitset& other) const;
+};
+
+// Subset queries on a growing list of toll sets
+// A stored set can only be a subset if its count and signature fit, so most sets are skipped without reading the bitsets
+struct toll_set_index
+{
+	std::vector<toll_bitset> sets;
+	std::vector<uint64_t> signatures;
+	std::vector<int> counts;
+
+	void insert(toll_bitset set);
+
+	// True if a stored set is included in the given set
+	bool has_subset_of(const toll_bitset& set) const;
+};
+
+// Monotone radix heap on integer keys
+// Popped keys never decrease, so an entry is stored in the bucket of the highest bit differing from the last popped key
+struct light_radix_heap
+{
+	using entry = std::pair<uint64_t, int>;
+	constexpr static int NUM_BUCKETS = 65;
+
+	uint64_t last;
+	size_t count;
+	std::vector<entry> buckets[NUM_BUCKETS];
+
+	light_radix_heap();
+
+	void clear();
+	void push(uint64_t key, int v);
+	void pop();
+	const entry& top();
+	bool empty() const { return count == 0; }
+
+	// Redistribute the first non-empty bucket when bucket 0 runs out
+	void refill();
+};
+
+// Reusable Dijkstra labels and heap
+// A label is valid only if its stamp equals the current generation, so reset() is O(1)
+struct light_workspace
+{
+	using cipair = std::pair<cost_type, int>;
+
+	unsigned int generation;
+	std::vector<unsigned int> reached;
+	std::vector<unsigned int> closed;
+	std::vector<cost_type> distances;
+	std::vector<int> parents;
+	std::vector<cipair> heap;
+
+	// Fixed-point labels of the radix heap engine
+	std::vector<uint64_t> keys;
+	light_radix_heap radix;
+
+	light_workspace();
+
+	// Start a new search on a graph with V nodes
+	void reset(int V);
+
+	bool is_reached(int v) const { return reached[v] == generation; }
+	bool is_closed(int v) const { return closed[v] == generation; }
+	cost_type distance(int v) const;
+	int parent(int v) const { return is_reached(v) ? parents[v] : -1; }
+
+	void label(int v, cost_type dist, int parent);
+	void close(int v) { closed[v] = generation; }
+
+	// Min-heap on (distance, node)
+	void push(cost_type dist, int v);
+	void pop();
+	const cipair& top() const { return heap.front(); }
+	bool empty() const { return heap.empty(); }
+
+	// Workspaces of the calling thread (the second one serves the backward side of bidirectional searches)
+	static light_workspace& local(int slot = 0);
+};
+
 struct light_graph
 {
 	using path = std::vector<int>;
@@ -27,17 +136,59 @@ struct light_graph
 	using toll_set = std::set<iipair>;
 	using toll_list = std::vector<iipair>;
 
+	// Read-only tolls indexed by light_edge::index, used instead of light_edge::toll when given
+	// (lets several threads search the same graph with different tolls)
+	using toll_overlay = std::vector<cost_type>;
+
+	enum heap_type {
+		BINARY_HEAP,
+		RADIX_HEAP
+	};
+	constexpr static double DEFAULT_RADIX_SCALE = 1e4;
+
+	enum search_type {
+		UNIDIRECTIONAL,
+		BIDIRECTIONAL,
+		ASTAR
+	};
+
 	int V;
 	std::vector<light_edge> Eall;
-	std::vector<std::map<int, int>> E;
-	std::vector<std::map<int, int>> Er;
+	light_adjacency E;
+	light_adjacency Er;
 	std::vector<int> temp_enabled_V;
 
+	// Size of the toll bitsets (largest light_edge::index + 1)
+	int toll_index_size;
+
+	// Undo log of the temporary states: nodes and arcs (Eall indices) disabled since the last restore
+	std::vector<int> temp_disabled_V;
+	std::vector<int> temp_disabled_arcs;
+
+	// Enumeration statistics: spur computations and restored undo log entries
+	long long spur_count;
+	long long temp_restore_count;
+
+	// Priority queue of the Dijkstra routine
+	// In RADIX_HEAP mode, arc weights (cost + toll) are rounded to multiples of 1 / radix_scale
+	heap_type heap;
+	double radix_scale;
+
+	// Point-to-point search of shortest_path (BIDIRECTIONAL and ASTAR always use the binary heap)
+	search_type search;
+
+	// A* potentials: toll-free distances to a destination with all arcs enabled, cached per destination
+	std::unordered_map<int, std::vector<cost_type>> potentials;
+
 	light_graph(int V);
 	light_graph(const problem_base::graph_type& graph);
 
+	// Rebuild E and Er from Eall (must be called after Eall is modified)
+	void build_adjacency();
+
 	int num_tolled() const;
 
+	int arc_index(int src, int dst) const;
 	light_edge& edge(int src, int dst);
 	light_edge& edge(const iipair& pair);
 	const light_edge& edge(int src, int dst) const;
@@ -46,16 +197,26 @@ struct light_graph
 	void clear_toll();
 
 	path shortest_path(int from, int to);
+	path shortest_path(light_workspace& ws, int from, int to, const toll_overlay* tolls = nullptr) const;
 	cost_type get_path_cost(const path& p, bool with_toll = true) const;
 	cost_type get_path_toll(const path& p) const;
+	cost_type get_path_toll(const path& p, const toll_overlay& tolls) const;
 	toll_set get_toll_set(const path& p) const;
 	toll_list get_toll_list(const path& p) const;
+	toll_bitset get_toll_bitset(const path& p) const;
 	bool is_toll_free(const path& p) const;
 
 	// Yen's algorithm
 	std::vector<path> k_shortest_paths(int from, int to, int k, bool toll_free_break = false);
 	void clear_temp_states();
 
+	// Journaled temporary states (the marks are sizes of the undo logs)
+	void disable_temp_node(int v);
+	void disable_temp_arc(int arc);
+	void disable_temp_arc(const iipair& pair) { disable_temp_arc(arc_index(pair.first, pair.second)); }
+	void restore_temp_nodes(int mark = 0);
+	void restore_temp_arcs(int mark = 0);
+
 	std::vector<path> filter_bilevel_feasible(const std::vector<path>& input) const;
 
 	std::vector<path> toll_unique_paths(int from, int to, int k);
@@ -70,4 +231,20 @@ struct light_graph
 
 	// Master routine
 	bool dijkstra(int from, std::vector<cost_type>& distances, std::vector<int>& parents, int to = -1, bool reversed = false) const;
+	bool dijkstra(light_workspace& ws, int from, int to = -1, bool reversed = false, const toll_overlay* tolls = nullptr) const;
+	bool dijkstra_binary(light_workspace& ws, int from, int to, bool reversed, const toll_overlay* tolls = nullptr) const;
+	bool dijkstra_radix(light_workspace& ws, int from, int to, bool reversed, const toll_overlay* tolls = nullptr) const;
+	path trace_path(const light_workspace& ws, int from, int to) const;
+
+	// Point-to-point variants
+	bool bidirectional_dijkstra(light_workspace& fws, light_workspace& bws, int from, int to, int& meet,
+								const toll_overlay* tolls = nullptr) const;
+	bool astar(light_workspace& ws, int from, int to, const std::vector<cost_type>& potential,
+			   const toll_overlay* tolls = nullptr) const;
+	const std::vector<cost_type>& potential(int dst);
+	std::vector<cost_type> lower_bounds_to_dst(int dst) const;
+
+	cost_type arc_toll(const light_edge& edge, const toll_overlay* tolls) const {
+		return (tolls != nullptr && edge.is_tolled) ? (*tolls)[edge.index] : edge.toll;
+	}
 };
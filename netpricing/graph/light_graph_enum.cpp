@@ -1,4 +1,5 @@
 #include "light_graph.h"
+#include "bilevel_path_enumerator.h"
 
 #include "../macros.h"
 
@@ -56,7 +57,7 @@ vector<path> light_graph::k_shortest_paths(int from, int to, int K, bool toll_fr
 
 				// if root_path_matchable[j] is true, all previous nodes of A[j] and new_path are matched
 				if (p.size() > i&& p[i] == spur_node) {
-					edge(p[i], p[i + 1]).temp_enabled = false;
+					disable_temp_arc(arc_index(p[i], p[i + 1]));
 				}
 				else {
 					root_path_matchable[j] = false;
@@ -64,12 +65,13 @@ vector<path> light_graph::k_shortest_paths(int from, int to, int K, bool toll_fr
 			}
 
 			// Remove all nodes in the root path except for the spur node
-			for (int node : new_path)
-				if (node != spur_node)
-					temp_enabled_V[node] = false;
+			// (the previous ones are still disabled, only the last one is added)
+			if (i > 0)
+				disable_temp_node(last_path[i - 1]);
 
 			// Calculate the spur path
 			path spur_path = shortest_path(spur_node, to);
+			spur_count++;
 			if (!spur_path.empty()) {
 				new_path.insert(new_path.end(), spur_path.begin() + 1, spur_path.end());
 				double cost = get_path_cost(new_path);
@@ -78,10 +80,13 @@ vector<path> light_graph::k_shortest_paths(int from, int to, int K, bool toll_fr
 				B.push(make_pair(cost, new_path));
 			}
 
-			// Restore the temp states
-			clear_temp_states();
+			// Restore the removed edges
+			restore_temp_arcs();
 		}
 
+		// Restore the root path
+		restore_temp_nodes();
+
 		// Break if there are no candidates
 		if (B.empty())
 			break;
@@ -113,17 +118,51 @@ vector<path> light_graph::k_shortest_paths(int from, int to, int K, bool toll_fr
 
 void light_graph::clear_temp_states()
 {
-	fill(temp_enabled_V.begin(), temp_enabled_V.end(), true);
-	for (auto& edge : Eall) edge.temp_enabled = true;
+	restore_temp_arcs();
+	restore_temp_nodes();
+}
+
+void light_graph::disable_temp_node(int v)
+{
+	if (temp_enabled_V[v]) {
+		temp_enabled_V[v] = false;
+		temp_disabled_V.push_back(v);
+	}
+}
+
+void light_graph::disable_temp_arc(int arc)
+{
+	if (Eall[arc].temp_enabled) {
+		Eall[arc].temp_enabled = false;
+		temp_disabled_arcs.push_back(arc);
+	}
+}
+
+void light_graph::restore_temp_nodes(int mark)
+{
+	temp_restore_count += temp_disabled_V.size() - mark;
+	while ((int)temp_disabled_V.size() > mark) {
+		temp_enabled_V[temp_disabled_V.back()] = true;
+		temp_disabled_V.pop_back();
+	}
+}
+
+void light_graph::restore_temp_arcs(int mark)
+{
+	temp_restore_count += temp_disabled_arcs.size() - mark;
+	while ((int)temp_disabled_arcs.size() > mark) {
+		Eall[temp_disabled_arcs.back()].temp_enabled = true;
+		temp_disabled_arcs.pop_back();
+	}
 }
 
 vector<path> light_graph::filter_bilevel_feasible(const vector<path>& input) const {
 	vector<path> output;
-	vector<toll_set> visited_sets;
+	toll_set_index visited_sets;
 
 	for (const path& path : input) {
 		// Get the set of toll arcs
-		toll_set toll_set = get_toll_set(path);
+		toll_bitset toll_set = get_toll_bitset(path);
 
 		// If the toll set is empty, break (because this's the last choice of the commodity)
 		if (toll_set.empty()) {
@@ -132,14 +171,11 @@ vector<path> light_graph::filter_bilevel_feasible(const vector<path>& input) con
 		}
 
 		// Check if it is superset of any previous set, if so, remove it
-		bool eliminated = std::any_of(visited_sets.begin(), visited_sets.end(),
-									  [&](const auto& s) {
-										  return std::includes(toll_set.begin(), toll_set.end(), s.begin(), s.end());
-									  });
+		bool eliminated = visited_sets.has_subset_of(toll_set);
 
 		// Add to visited sets if not eliminated
 		if (!eliminated) {
-			visited_sets.emplace_back(std::move(toll_set));
+			visited_sets.insert(std::move(toll_set));
 			output.push_back(path);
 		}
 	}
@@ -160,8 +196,9 @@ vector<path> light_graph::bilevel_feasible_paths(int from, int to, int K)
 
 	clear_temp_states();
 
-	// List of shortest paths A
+	// List of shortest paths A (and their toll sets)
 	vector<qentry> A;
+	toll_set_index A_sets;
 	vector<path> rpaths;
 
 	// Heap of candidates B
@@ -173,6 +210,7 @@ vector<path> light_graph::bilevel_feasible_paths(int from, int to, int K)
 		cost_type cost = get_path_cost(first_path);
 		toll_list tlist = get_toll_list(first_path);
 		rpaths.push_back(first_path);
+		A_sets.insert(get_toll_bitset(first_path));
 		A.emplace_back(cost, std::move(first_path), std::move(tlist));
 	}
 	else
@@ -193,20 +231,23 @@ vector<path> light_graph::bilevel_feasible_paths(int from, int to, int K)
 		// Look up for root path mismatch
 		vector<bool> root_path_matchable(A.size(), true);
 
+		// Nodes of the root path already disabled
+		auto blocked_it = last_path.begin();
+
 		// For each toll arc in the toll set
 		for (int i = -1; i < (int)(last_tlist.size()) - 1; i++) {
 			// Get the spur node (the end of the previous toll arc or the origin)
 			int spur_node = (i < 0) ? from : last_tlist[i].second;
 
-			// Root path (later total path)
-			auto spur_node_it = std::find(last_path.begin(), last_path.end(), spur_node);
+			// Root path (later total path), spur nodes advance along the path
+			auto spur_node_it = std::find(blocked_it, last_path.end(), spur_node);
 			path new_path(last_path.begin(), spur_node_it);
 
 			// If i = -1, remove first toll arc in all paths in A
 			if (i < 0) {
 				for (int j = 0; j < A.size(); j++) {
 					const toll_list& tlist = std::get<2>(A[j]);
-					edge(tlist[0]).temp_enabled = false;
+					disable_temp_arc(tlist[0]);
 				}
 			}
 			// If another shortest path shares the same sublist of toll arcs up to tlist[i], remove the next toll arc
@@ -219,7 +260,7 @@ vector<path> light_graph::bilevel_feasible_paths(int from, int to, int K)
 
 					// if root_path_matchable[j] is true, all previous toll arcs of A[j] and new_path are matched
 					if (tlist.size() > i + 1 && tlist[i] == last_tlist[i]) {
-						edge(tlist[i + 1]).temp_enabled = false;
+						disable_temp_arc(tlist[i + 1]);
 					}
 					else {
 						root_path_matchable[j] = false;
@@ -227,13 +268,13 @@ vector<path> light_graph::bilevel_feasible_paths(int from, int to, int K)
 				}
 			}
 
-			// Remove all nodes in the root path except for the spur node
-			for (int node : new_path)
-				if (node != spur_node)
-					temp_enabled_V[node] = false;
+			// Remove all nodes in the root path except for the spur node (only the new ones)
+			for (; blocked_it != spur_node_it; ++blocked_it)
+				disable_temp_node(*blocked_it);
 
 			// Calculate the spur path
 			path spur_path = shortest_path(spur_node, to);
+			spur_count++;
 			if (!spur_path.empty()) {
 				new_path.insert(new_path.end(), spur_path.begin(), spur_path.end());
 				cost_type cost = get_path_cost(new_path);
@@ -244,10 +285,13 @@ vector<path> light_graph::bilevel_feasible_paths(int from, int to, int K)
 				B.emplace(cost, std::move(new_path), std::move(new_tlist));
 			}
 
-			// Restore the temp states
-			clear_temp_states();
+			// Restore the removed toll arcs
+			restore_temp_arcs();
 		}
 
+		// Restore the root path
+		restore_temp_nodes();
+
 		// Break if there are no candidates
 		if (B.empty())
 			break;
@@ -258,14 +302,8 @@ vector<path> light_graph::bilevel_feasible_paths(int from, int to, int K)
 			B.pop();
 
 		// Check for dominance condition
-		const vector<iipair>& best_tlist = std::get<2>(best_entry);
-		toll_set best_tset(best_tlist.begin(), best_tlist.end());
-		if (all_of(A.begin(), A.end(),
-				   [&](const auto& entry) {
-					   const vector<iipair>& tlist = std::get<2>(entry);
-					   toll_set tset(tlist.begin(), tlist.end());
-					   return !std::includes(best_tset.begin(), best_tset.end(), tset.begin(), tset.end());
-				   })) {
+		toll_bitset best_tset = get_toll_bitset(std::get<1>(best_entry));
+		if (!A_sets.has_subset_of(best_tset)) {
 			rpaths.push_back(std::get<1>(best_entry));
 			if (rpaths.size() >= K)
 				break;
@@ -281,6 +319,7 @@ vector<path> light_graph::bilevel_feasible_paths(int from, int to, int K)
 			cout << "    superset of " << std::get<2>(*it) << "    " << std::get<0>(*it) << endl;
 		}*/
 
+		A_sets.insert(std::move(best_tset));
 		A.emplace_back(std::move(best_entry));
 	}
 
@@ -314,152 +353,11 @@ vector<path> light_graph::toll_unique_paths(int from, int to, int k)
 	return rpaths;
 }
 
-struct bfpath2_entry {
-	vector<int> path;
-	cost_type cost;
-	int spur_node;
-	vector<iipair> removed;
-};
-struct bfpath2_compare {
-	bool operator()(const bfpath2_entry* a, const bfpath2_entry* b) {
-	// Reverse the order, smaller is better
-		return a->cost > b->cost;
-	}
-};
-
 vector<path> light_graph::bilevel_feasible_paths_2(int from, int to, int K, bool filter)
 {
-	clear_temp_states();
-
-	// List of shortest paths A
-	vector<path> A;
-
-	// Heap of candidates B
-	std::priority_queue<bfpath2_entry*, vector<bfpath2_entry*>, bfpath2_compare> B;
-
-	vector<toll_set> visited_sets;
-
-	// First shortest path
-	path first_path = shortest_path(from, to);
-	if (!first_path.empty()) {
-		cost_type cost = get_path_cost(first_path);
-		toll_list tlist = get_toll_list(first_path);
-		B.push(new bfpath2_entry {
-			.path = first_path,
-			.cost = get_path_cost(first_path),
-			.spur_node = from,
-			.removed = vector<iipair>() });
-	}
-	// Disconnected
-	else
+	if (K <= 0)
 		return vector<path>();
 
-	while (!B.empty() && A.size() < K) {
-		// Get the best candidate path
-		bfpath2_entry* last_entry = B.top();
-		B.pop();
-
-		const path& last_path = last_entry->path;
-		cost_type last_cost = last_entry->cost;
-		int last_spur_node = last_entry->spur_node;
-		const auto& last_removed = last_entry->removed;
-
-		if (filter) {
-			// Check if it is superset of any previous set
-			toll_set tset = get_toll_set(last_path);
-			bool dominated = std::any_of(visited_sets.begin(), visited_sets.end(),
-										 [&](const auto& s) {
-											 return std::includes(tset.begin(), tset.end(), s.begin(), s.end());
-										 });
-		   // Add to output if not dominated
-			if (!dominated) {
-				A.push_back(last_path);
-				visited_sets.emplace_back(std::move(tset));
-			}
-		} else
-			A.push_back(last_path);
-
-		auto last_tlist = get_toll_list(last_path);
-
-		// The last path is toll-free path, stop
-		if (last_tlist.empty())
-			break;
-
-		// Find the first toll arcs succeeding spur_node
-		toll_list::iterator it;
-		if (last_spur_node == from)
-			it = last_tlist.begin();
-		else {
-			it = std::find_if(last_tlist.begin(), last_tlist.end(),
-							  [&](const auto& pair) {
-								  return pair.second == last_spur_node;
-							  });
-			assert(it != last_tlist.end()); // This iterator must exist
-			it++;
-		}
-
-		int spur_node = last_spur_node;
-		cost_type upper_bound = numeric_limits<cost_type>::infinity();
-
-		// Generate subproblems
-		for (; it != last_tlist.end(); it++) {
-			vector<iipair> curr_removed = last_removed;
-			curr_removed.push_back(*it);
-
-			// Copy the subpath
-			path curr_path;
-			if (spur_node != from) {
-				auto spur_it = std::find(last_path.begin(), last_path.end(), spur_node);
-				curr_path = vector<int>(last_path.begin(), spur_it);
-			}
-
-			// Disable arcs and nodes
-			for (auto& pair : curr_removed) {
-				edge(pair).temp_enabled = false;
-			}
-
-			for (int node : curr_path)
-				if (node != spur_node)
-					temp_enabled_V[node] = false;
-
-			// Find the second segment
-			path spur_path = shortest_path(spur_node, to);
-			if (!spur_path.empty()) {
-				curr_path.insert(curr_path.end(), spur_path.begin(), spur_path.end());
-				cost_type path_cost = get_path_cost(curr_path);
-
-				// Check upper bound, only add if smaller
-				if (path_cost < upper_bound) {
-					B.push(new bfpath2_entry{
-						.path = curr_path,
-						.cost = get_path_cost(curr_path),
-						.spur_node = spur_node,
-						.removed = std::move(curr_removed) });
-
-					// If the spur path is toll-free, set it as the new upper bound
-					if (is_toll_free(spur_path)) {
-						upper_bound = path_cost;
-					}
-				}
-			}
-
-			// Restore the temp states
-			clear_temp_states();
-
-			// Set the next spur node
-			spur_node = it->second;
-		}
-
-		delete last_entry;
-	}
-
-	// Cleaning up
-	while (!B.empty()) {
-		bfpath2_entry* entry = B.top();
-		B.pop();
-		delete entry;
-	}
-
-	return A;
+	bilevel_path_enumerator enumerator(*this, from, to, filter);
+	return enumerator.take(K);
 }
-
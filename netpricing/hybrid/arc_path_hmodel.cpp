@@ -25,9 +25,7 @@ vector<formulation*> arc_path_hmodel<arc_path_form, alternative>::assign_formula
 
 	std::vector<formulation*> all_forms(K);
 	LOOP(k, K) {
-		auto paths = lgraph.bilevel_feasible_paths(prob.commodities[k].origin,
-												   prob.commodities[k].destination,
-												   max_paths + 1);
+		auto paths = cached_bilevel_feasible_paths(lgraph, k, max_paths + 1);
 		if (paths.size() <= 1) {
 			all_forms[k] = new null_formulation();
 			filtered_count++;
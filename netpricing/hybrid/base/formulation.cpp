@@ -2,22 +2,37 @@
 
 #include "hybrid_model.h"
 
-void formulation::formulate(hybrid_model* model, int k) {
+#include <iostream>
+
+void formulation::prepare(hybrid_model* model, int k) {
 	this->model = model;
 	this->k = k;
 
-	env = model->env;
 	prob = &model->prob;
 
-	cplex_model = model->cplex_model;
-	obj = model->obj;
-	t = model->t;
-
 	K = model->K;
 	V = model->V;
 	A = model->A;
 	A1 = model->A1;
 	A2 = model->A2;
 
+	prepare_impl();
+	prepared = true;
+}
+
+void formulation::formulate(hybrid_model* model, int k) {
+	if (!prepared)
+		prepare(model, k);
+
+	// Preprocessing report, flushed in commodity order
+	std::cout << prep_log.str();
+	prep_log.str("");
+
+	env = model->env;
+
+	cplex_model = model->cplex_model;
+	obj = model->obj;
+	t = model->t;
+
 	formulate_impl();
 }
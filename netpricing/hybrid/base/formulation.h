@@ -2,6 +2,8 @@
 
 #include "../../model.h"
 
+#include <sstream>
+
 struct hybrid_model;
 
 struct formulation : public cplex_def {
@@ -9,7 +11,7 @@ struct formulation : public cplex_def {
 	int k;
 
 	IloEnv env;
-	problem* prob;
+	const problem* prob;
 
 	IloModel cplex_model;
 	IloObjective obj;
@@ -17,6 +19,13 @@ struct formulation : public cplex_def {
 
 	int K, V, A, A1, A2;
 
+	// Commodity-local preprocessing (no Concert object is created, so it can run concurrently)
+	bool prepared = false;
+	std::ostringstream prep_log;
+
+	void prepare(hybrid_model* model, int k);
+	virtual void prepare_impl() {}
+
 	void formulate(hybrid_model* model, int k);
 	virtual void formulate_impl() = 0;
 
@@ -29,6 +38,9 @@ struct formulation : public cplex_def {
 	virtual std::vector<std::pair<IloNumVar, IloNum>> path_to_solution(const NumArray& tvals,
 																  const std::vector<int>& path) = 0;
 
+	// Whether path_to_solution accepts this path (formulations over a path pool may not)
+	virtual bool can_represent(const std::vector<int>& path) { return true; }
+
 	// Callback to add lazy constraint
 	virtual bool has_callback() { return false; }
 	virtual void invoke_callback(const IloCplex::Callback::Context& context, const NumArray& tvals) {}
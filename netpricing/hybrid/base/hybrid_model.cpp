@@ -4,6 +4,7 @@
 #include "../../macros.h"
 #include "../../utilities/set_var_name.h"
 #include "../../models/model_utils.h"
+#include "../../utilities/thread_pool.h"
 
 #include <iostream>
 
@@ -125,10 +126,13 @@ struct hybrid_callback : public IloCplex::Callback::Function {
 
 		// Test for objective
 		double obj = 0;
-		LOOP(k, model.K) obj += model.heur_solver.lgraph.get_path_toll(paths[k]) * model.prob.commodities[k].demand / 0.9999;
+		LOOP(k, model.K) obj += model.heur_solver.lgraph.get_path_toll(paths[k], model.heur_solver.toll_overlay) * model.prob.commodities[k].demand / follower_light_solver::TOLL_PREFERENCE;
 
-		// Post solution if better
-		if (obj > context.getIncumbentObjective()) {
+		// Post solution if better (and representable by every formulation)
+		bool representable = true;
+		LOOP(k, model.K) representable = representable && model.all_formulations[k]->can_represent(paths[k]);
+
+		if (representable && obj > context.getIncumbentObjective()) {
 			vector<pair<IloNumVar, IloNum>> all_pairs;
 
 			// Add values of T
@@ -183,8 +187,8 @@ struct hybrid_callback : public IloCplex::Callback::Function {
 
 hybrid_model::hybrid_model(IloEnv& env, const problem& _prob) :
 	model_with_generic_callback(env), model_single(_prob),
-	t(env, A1, 0, IloInfinity), heur_freq(100),
-	cb_time(0), cb_count(0), heur_time(0), heur_count(0),
+	t(env, A1, 0, IloInfinity), prep_threads(1), distances(prob),
+	cb_time(0), cb_count(0), heur_time(0), heur_count(0), heur_freq(100),
 	heur_solver(prob)
 {
 	SET_VAR_NAMES(*this, t);
@@ -204,9 +208,27 @@ hybrid_model::~hybrid_model()
 void hybrid_model::formulate()
 {
 	all_formulations = assign_formulations();
+	if (paths_cache.enabled())
+		cout << "Path cache: " << paths_cache.hits.load() << " hits, " << paths_cache.misses.load() << " misses" << endl;
+
+	// Preprocess the commodities concurrently, the Concert model is then built serially
+	if (prep_threads > 1) {
+		thread_pool pool(prep_threads);
+		pool.run(K, [&](int k) {
+			all_formulations[k]->prepare(this, k);
+		});
+	}
+
 	LOOP(k, K) {
 		all_formulations[k]->formulate(this, k);
 	}
+
+	if (distances.misses > 0)
+		cout << "Distance cache: " << distances.hits.load() << " hits, " << distances.misses.load() << " misses ("
+			<< distances.hit_rate() * 100 << "% hit rate), " << (distances.memory.load() >> 20) << " MB" << endl;
+
+	// Only the preprocessing uses the trees
+	distances.clear();
 }
 
 bool hybrid_model::solve_impl()
@@ -294,4 +316,16 @@ void hybrid_model::config(const model_config& conf)
 	model_cplex::config(conf);
 	if (conf.heur_freq >= 0)
 		heur_freq = conf.heur_freq;
+	heur_solver.set_num_threads(conf.follower_threads);
+	prep_threads = conf.num_thread;
+	if (!conf.path_cache_dir.empty())
+		paths_cache.open(conf.path_cache_dir, prob);
+}
+
+vector<vector<int>> hybrid_model::cached_bilevel_feasible_paths(light_graph& graph, int k, int num_paths)
+{
+	const commodity& comm = prob.commodities[k];
+	return paths_cache.get("bfp", k, false, num_paths, [&](int n) {
+		return graph.bilevel_feasible_paths(comm.origin, comm.destination, n);
+	});
 }
@@ -2,6 +2,8 @@
 
 #include "../../models/model_cplex.h"
 #include "../../utilities/follower_light_solver.h"
+#include "../../utilities/path_cache.h"
+#include "../../utilities/distance_oracle.h"
 
 #include <vector>
 
@@ -13,6 +15,15 @@ struct hybrid_model : public model_with_generic_callback, public model_single {
 
 	std::vector<formulation*> all_formulations;
 
+	// Threads for the commodity-local preprocessing (before CPLEX runs)
+	int prep_threads;
+
+	// Enumerated paths shared between runs on the same instance
+	path_cache paths_cache;
+
+	// Shortest path trees of the problem graph, shared by the commodity preprocessors
+	distance_oracle distances;
+
 	// Callback variables
 	double cb_time;
 	int cb_count;
@@ -29,6 +40,9 @@ struct hybrid_model : public model_with_generic_callback, public model_single {
 	void formulate();
 	virtual std::vector<formulation*> assign_formulations() = 0;
 
+	// At most num_paths bilevel feasible paths of commodity k on the original graph
+	std::vector<std::vector<int>> cached_bilevel_feasible_paths(light_graph& graph, int k, int num_paths);
+
 	// Inherited via model_with_generic_callbacks
 	virtual bool solve_impl() override;
 	virtual solution get_solution() override;
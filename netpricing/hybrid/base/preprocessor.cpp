@@ -5,225 +5,373 @@
 
 #include "../../problem.h"
 #include "../../macros.h"
+#include "../../utilities/distance_oracle.h"
 
 using namespace std;
 
+preprocessor::preprocessor() : log(&cout), oracle(nullptr)
+{
+}
+
+void index_set::insert(int i)
+{
+	if (i >= (int)flags.size())
+		flags.resize(i + 1, false);
+	if (!flags[i]) {
+		flags[i] = true;
+		num++;
+	}
+}
+
+void index_set::erase(int i)
+{
+	if (!count(i))
+		return;
+	flags[i] = false;
+	num--;
+
+	// Keep bound() tight
+	while (!flags.empty() && !flags.back())
+		flags.pop_back();
+}
+
+index_set::iterator index_set::begin() const
+{
+	int i = 0;
+	while (i < (int)flags.size() && !flags[i])
+		i++;
+	return iterator{ &flags, i };
+}
+
+int preprocess_info::add_arc(int src, int dst, cost_type cost, int a1)
+{
+	int a = arc_A.size();
+
+	A.insert(a);
+	arc_A.emplace_back(src, dst);
+	cost_A.push_back(cost);
+	is_tolled.push_back(a1 >= 0);
+
+	// The first arc of a (src, dst) pair is kept
+	arc_index.emplace(arc_key(src, dst), a);
+
+	if (a1 >= 0) {
+		if (a1 >= (int)arc_A1.size()) {
+			arc_A1.resize(a1 + 1);
+			cost_A1.resize(a1 + 1);
+			a1_to_a_index.resize(a1 + 1, -1);
+		}
+
+		A1.insert(a1);
+		arc_A1[a1] = make_pair(src, dst);
+		cost_A1[a1] = cost;
+		a1_to_a_index[a1] = a;
+		a_to_sub.push_back(a1);
+	}
+	else {
+		int a2 = arc_A2.size();
+
+		A2.insert(a2);
+		arc_A2.emplace_back(src, dst);
+		cost_A2.push_back(cost);
+		a2_to_a_index.push_back(a);
+		a_to_sub.push_back(a2);
+	}
+
+	return a;
+}
+
 int preprocess_info::a_to_a1(int a) const
 {
-	return bimap_A1.right.at(bimap_A.left.at(a));
+	if (!is_tolled.at(a))
+		throw out_of_range("arc is not tolled");
+	return a_to_sub[a];
 }
 
 int preprocess_info::a_to_a2(int a) const
 {
-	return bimap_A2.right.at(bimap_A.left.at(a));
+	if (is_tolled.at(a))
+		throw out_of_range("arc is tolled");
+	return a_to_sub[a];
 }
 
 int preprocess_info::a1_to_a(int a1) const
 {
-	return bimap_A.right.at(bimap_A1.left.at(a1));
+	int a = a1_to_a_index.at(a1);
+	if (a < 0)
+		throw out_of_range("no arc with this toll index");
+	return a;
 }
 
 int preprocess_info::a2_to_a(int a2) const
 {
-	return bimap_A.right.at(bimap_A2.left.at(a2));
+	return a2_to_a_index.at(a2);
 }
 
 int preprocess_info::src_dst_to_a(int src, int dst) const
 {
-	return bimap_A.right.at(make_pair(src, dst));
+	return arc_index.at(arc_key(src, dst));
 }
 
 int preprocess_info::src_dst_to_a1(int src, int dst) const
 {
-	return bimap_A1.right.at(make_pair(src, dst));
+	return a_to_a1(src_dst_to_a(src, dst));
 }
 
 int preprocess_info::src_dst_to_a2(int src, int dst) const
 {
-	return bimap_A2.right.at(make_pair(src, dst));
+	return a_to_a2(src_dst_to_a(src, dst));
+}
+
+void preprocess_info::set_arc(int a, int src, int dst)
+{
+	auto it = arc_index.find(arc_key(arc_A[a].first, arc_A[a].second));
+	if (it != arc_index.end() && it->second == a)
+		arc_index.erase(it);
+	arc_index[arc_key(src, dst)] = a;
+
+	arc_A[a] = make_pair(src, dst);
+	if (is_tolled[a])
+		arc_A1[a_to_sub[a]] = arc_A[a];
+	else
+		arc_A2[a_to_sub[a]] = arc_A[a];
+}
+
+std::vector<int> preprocess_info::expand_path(const std::vector<int>& path) const
+{
+	if (path.empty() || expansion.empty())
+		return path;
+
+	vector<int> full{ path[0] };
+	for (int i = 0; i < (int)path.size() - 1; i++) {
+		auto it = expansion.find(src_dst_to_a(path[i], path[i + 1]));
+		if (it != expansion.end())
+			full.insert(full.end(), it->second.begin(), it->second.end());
+		else
+			full.push_back(path[i + 1]);
+	}
+	return full;
 }
 
 void preprocess_info::prune(int orig, int dest)
 {
-	map<int, set<int>> forward;
-	map<int, set<int>> backward;
+	int n = V.bound();
+	for (int a : A)
+		n = std::max({ n, arc_A[a].first + 1, arc_A[a].second + 1 });
 
-	for (int a : A) {
-		auto pair = bimap_A.left.at(a);
-		int src = pair.first, dst = pair.second;
+	vector<vector<int>> out_arcs(n), in_arcs(n);
+	vector<int> out_degree(n, 0), in_degree(n, 0);
 
-		forward[src].insert(dst);
-		backward[dst].insert(src);
+	for (int a : A) {
+		int src = arc_A[a].first, dst = arc_A[a].second;
+		out_arcs[src].push_back(a);
+		in_arcs[dst].push_back(a);
+		out_degree[src]++;
+		in_degree[dst]++;
 	}
 
-	// Remove all nodes that don't have any outward arc or inward arc
-	while (true) {
-		set<int> to_be_removed;
-		for (int i : V)
-			if (i != orig && i != dest && (forward[i].empty() || backward[i].empty()))
-				to_be_removed.insert(i);
-
-		if (to_be_removed.empty())
-			break;
-
-		for (int i : to_be_removed) {
-			V.erase(i);
-
-			for (int j : forward[i]) {
-				int a = src_dst_to_a(i, j);
-				A.erase(a);
-				if (is_tolled.at(a)) A1.erase(a_to_a1(a));
-				else A2.erase(a_to_a2(a));
-				backward[j].erase(i);
-			}
-
-			for (int j : backward[i]) {
-				int a = src_dst_to_a(j, i);
-				A.erase(a);
-				if (is_tolled.at(a)) A1.erase(a_to_a1(a));
-				else A2.erase(a_to_a2(a));
-				forward[j].erase(i);
-			}
-
-			forward[i].clear();
-			backward[i].clear();
+	auto remove_arc = [&](int a) {
+		A.erase(a);
+		if (is_tolled[a]) A1.erase(a_to_sub[a]);
+		else A2.erase(a_to_sub[a]);
+	};
+
+	// Remove all nodes that don't have any outward arc or inward arc, until none is left
+	auto is_dead = [&](int i) {
+		return V.count(i) && i != orig && i != dest && (out_degree[i] == 0 || in_degree[i] == 0);
+	};
+
+	vector<int> to_be_removed;
+	for (int i : V)
+		if (is_dead(i))
+			to_be_removed.push_back(i);
+
+	while (!to_be_removed.empty()) {
+		int i = to_be_removed.back();
+		to_be_removed.pop_back();
+		if (!V.count(i))
+			continue;
+		V.erase(i);
+
+		for (int a : out_arcs[i]) {
+			if (!A.count(a)) continue;
+			remove_arc(a);
+			int j = arc_A[a].second;
+			in_degree[j]--;
+			if (is_dead(j)) to_be_removed.push_back(j);
 		}
-	}
 
+		for (int a : in_arcs[i]) {
+			if (!A.count(a)) continue;
+			remove_arc(a);
+			int j = arc_A[a].first;
+			out_degree[j]--;
+			if (is_dead(j)) to_be_removed.push_back(j);
+		}
+	}
 }
 
 void preprocess_info::reduce(int orig, int dest)
 {
 	clean();
 
-	map<int, set<int>> forward;
-	map<int, set<int>> backward;
+	int n = V.bound();
+	vector<vector<int>> forward(n), backward(n);
 
 	for (int a : A) {
-		auto pair = bimap_A.left.at(a);
-		int src = pair.first, dst = pair.second;
-
-		forward[src].insert(dst);
-		backward[dst].insert(src);
+		int src = arc_A[a].first, dst = arc_A[a].second;
+		forward[src].push_back(dst);
+		backward[dst].push_back(src);
 	}
 
+	auto connected = [](const vector<int>& nodes, int i) {
+		return std::find(nodes.begin(), nodes.end(), i) != nodes.end();
+	};
+
 	// Remove chain of toll-free arcs
-	map<int, pair<int, int>> chain_nodes;
+	vector<char> is_chain(n, false);
+	vector<pair<int, int>> chain(n);		// Previous and next node of the chain nodes
 	for (int i : V) {
 		if (i != orig && i != dest && forward[i].size() == 1 && backward[i].size() == 1) {
 			// Test if both arcs are toll-free
-			int j = *backward[i].begin();
-			int k = *forward[i].begin();
+			int j = backward[i][0];
+			int k = forward[i][0];
 
-			if (is_tolled.at(src_dst_to_a(j, i))) continue;
-			if (is_tolled.at(src_dst_to_a(i, k))) continue;
+			if (is_tolled[src_dst_to_a(j, i)]) continue;
+			if (is_tolled[src_dst_to_a(i, k)]) continue;
 
 			// Test if they are not connected
-			if (forward[j].count(k)) continue;
+			if (connected(forward[j], k)) continue;
 
-			chain_nodes.emplace(i, make_pair(j, k));
+			is_chain[i] = true;
+			chain[i] = make_pair(j, k);
 		}
 	}
 
-	while (!chain_nodes.empty()) {
-		auto entry = *chain_nodes.begin();
-		chain_nodes.erase(entry.first);
+	for (int root = 0; root < n; root++) {
+		if (!is_chain[root]) continue;
+		is_chain[root] = false;
 
 		// Start and end node of the chain
-		int root = entry.first;
-		int start = entry.second.first;
-		int end = entry.second.second;
-		cost_type cost = cost_A2.at(src_dst_to_a2(start, root)) + cost_A2.at(src_dst_to_a2(root, end));
+		int start = chain[root].first;
+		int end = chain[root].second;
 
 		int root_a = src_dst_to_a(start, root);
-		int root_a2 = src_dst_to_a2(start, root);
+		int end_a = src_dst_to_a(root, end);
+		cost_type cost = cost_A[root_a] + cost_A[end_a];
 
 		V.erase(root);
-		A.erase(src_dst_to_a(root, end));
-		A2.erase(src_dst_to_a2(root, end));
+		A.erase(end_a);
+		A2.erase(a_to_sub[end_a]);
 
 		// Trace the end
-		while (chain_nodes.count(end)) {
-			int new_end = chain_nodes[end].second;
+		while (is_chain[end]) {
+			int new_end = chain[end].second;
+			is_chain[end] = false;
 
 			// If there is already an arc between start and new_end, stop here to prevent overriding existing arc
-			if (backward[new_end].count(start)) {
-				chain_nodes.erase(end);
+			if (connected(backward[new_end], start))
 				break;
-			}
-			else {
-				V.erase(end);
-				cost += cost_A2.at(src_dst_to_a2(end, new_end));
-				A.erase(src_dst_to_a(end, new_end));
-				A2.erase(src_dst_to_a2(end, new_end));
-
-				chain_nodes.erase(end);
-				end = new_end;
-			}
+
+			int a = src_dst_to_a(end, new_end);
+			V.erase(end);
+			cost += cost_A[a];
+			A.erase(a);
+			A2.erase(a_to_sub[a]);
+
+			end = new_end;
 		}
 
 		// Trace back the start
-		while (chain_nodes.count(start)) {
-			int new_start = chain_nodes[start].first;
+		while (is_chain[start]) {
+			int new_start = chain[start].first;
+			is_chain[start] = false;
 
 			// If there is already an arc between new_start and end, stop here to prevent overriding existing arc
-			if (forward[new_start].count(end)) {
-				chain_nodes.erase(start);
+			if (connected(forward[new_start], end))
 				break;
-			}
-			else {
-				V.erase(start);
-				cost += cost_A2.at(src_dst_to_a2(new_start, start));
-				A.erase(src_dst_to_a(new_start, start));
-				A2.erase(src_dst_to_a2(new_start, start));
-
-				chain_nodes.erase(start);
-				start = new_start;
-			}
-		}
 
-		// Modify the root arc
-		bimap_A.left.replace_data(bimap_A.left.find(root_a), make_pair(start, end));
-		bimap_A2.left.replace_data(bimap_A2.left.find(root_a2), make_pair(start, end));
+			int a = src_dst_to_a(new_start, start);
+			V.erase(start);
+			cost += cost_A[a];
+			A.erase(a);
+			A2.erase(a_to_sub[a]);
 
-		auto trace = bimap_A2.left.at(root_a2);
+			start = new_start;
+		}
 
-		cost_A[root_a] = cost_A2[root_a2] = cost;
+		// Modify the root arc
+		set_arc(root_a, start, end);
+		cost_A[root_a] = cost_A2[a_to_sub[root_a]] = cost;
 	}
 }
 
 void preprocess_info::clean()
 {
-	// Clear unlisted bimap and map entry
-#define CLEAR_UNLISTED(map, set, var) \
-	for (auto it = map.begin(); it != map.end();) { \
-		if (!set.count(it->var)) \
-			it = map.erase(it); \
-		else \
-			it++; \
-	}
+	// Drop the removed arcs, A and A2 are renumbered in the same order
+	vector<arc> new_arc_A, new_arc_A2;
+	vector<cost_type> new_cost_A, new_cost_A2;
+	vector<char> new_is_tolled;
+	vector<int> new_a_to_sub, new_a2_to_a_index;
+	unordered_map<int, vector<int>> new_expansion;
+
+	a1_to_a_index.assign(a1_to_a_index.size(), -1);
+	A1.clear();
+	A2.clear();
 
-	CLEAR_UNLISTED(bimap_A, A, left);
-	CLEAR_UNLISTED(bimap_A1, A1, left);
-	CLEAR_UNLISTED(bimap_A2, A2, left);
+	for (int a : A) {
+		int new_a = new_arc_A.size();
 
-	CLEAR_UNLISTED(cost_A, A, first);
-	CLEAR_UNLISTED(cost_A1, A1, first);
-	CLEAR_UNLISTED(cost_A2, A2, first);
+		new_arc_A.push_back(arc_A[a]);
+		new_cost_A.push_back(cost_A[a]);
+		new_is_tolled.push_back(is_tolled[a]);
 
-	CLEAR_UNLISTED(is_tolled, A, first);
+		if (is_tolled[a]) {
+			int a1 = a_to_sub[a];
+			A1.insert(a1);
+			a1_to_a_index[a1] = new_a;
+			new_a_to_sub.push_back(a1);
+		}
+		else {
+			int new_a2 = new_arc_A2.size();
+			A2.insert(new_a2);
+			new_arc_A2.push_back(arc_A[a]);
+			new_cost_A2.push_back(cost_A2[a_to_sub[a]]);
+			new_a2_to_a_index.push_back(new_a);
+			new_a_to_sub.push_back(new_a2);
+		}
+
+		auto it = expansion.find(a);
+		if (it != expansion.end())
+			new_expansion.emplace(new_a, std::move(it->second));
+	}
+
+	arc_A = std::move(new_arc_A);
+	arc_A2 = std::move(new_arc_A2);
+	cost_A = std::move(new_cost_A);
+	cost_A2 = std::move(new_cost_A2);
+	is_tolled = std::move(new_is_tolled);
+	a_to_sub = std::move(new_a_to_sub);
+	a2_to_a_index = std::move(new_a2_to_a_index);
+	expansion = std::move(new_expansion);
+
+	A.clear();
+	arc_index.clear();
+	LOOP(a, (int)arc_A.size()) {
+		A.insert(a);
+		arc_index.emplace(arc_key(arc_A[a].first, arc_A[a].second), a);
+	}
 }
 
 light_graph preprocess_info::build_graph()
 {
-	light_graph lgraph(*(V.rbegin()) + 1);
+	light_graph lgraph(V.bound());
 
-	problem_base::edge_iterator ei, ei_end;
 	for (int a : A) {
-		auto arc = bimap_A.left.at(a);
-		cost_type cost = cost_A.at(a);
-		bool tolled = is_tolled.at(a);
-		int index = tolled ? a_to_a1(a) : -1;
+		auto arc = arc_A[a];
+		cost_type cost = cost_A[a];
+		bool tolled = is_tolled[a];
+		int index = tolled ? a_to_sub[a] : -1;
 
 		lgraph.Eall.emplace_back(light_edge{
 			.index = index,
@@ -237,52 +385,27 @@ light_graph preprocess_info::build_graph()
 								 });
 	}
 
-	LOOP(a, lgraph.Eall.size()) {
-		auto& edge = lgraph.Eall[a];
-		lgraph.E[edge.src].emplace(edge.dst, a);
-		lgraph.Er[edge.dst].emplace(edge.src, a);
-	}
+	lgraph.build_adjacency();
 
 	return lgraph;
 }
 
 preprocess_info preprocessor::preprocess(const problem& prob, int k) {
+	// The oracle graph is converted once, and tells the subclasses that its distances apply
+	if (oracle)
+		return preprocess_impl(oracle->graph, prob.commodities[k], k);
 	return preprocess_impl(prob.graph, prob.commodities[k], k);
 }
 
 // Default proprocessor: extract problem to preprocess_info
 preprocess_info preprocessor::preprocess_impl(const light_graph& graph, const commodity& comm, int k)
 {
-	using arc_bimap_rel = preprocess_info::arc_bimap::value_type;
-
 	preprocess_info info;
 
 	LOOP(i, graph.V) info.V.insert(i);
 
-	int a2 = 0;
-	LOOP(a, graph.Eall.size()) {
-		info.A.insert(a);
-
-		const light_edge& e = graph.Eall.at(a);
-		cost_type cost = e.cost;
-		bool is_tolled = e.is_tolled;
-
-		info.bimap_A.insert(arc_bimap_rel(a, make_pair(e.src, e.dst)));
-		info.cost_A.emplace(a, cost);
-		info.is_tolled.emplace(a, is_tolled);
-
-	 	if (is_tolled) {
-			info.bimap_A1.insert(arc_bimap_rel(e.index, make_pair(e.src, e.dst)));
-			info.cost_A1.emplace(e.index, cost);
-			info.A1.insert(e.index);
-		}
-		else {
-			info.bimap_A2.insert(arc_bimap_rel(a2, make_pair(e.src, e.dst)));
-			info.cost_A2.emplace(a2, cost);
-			info.A2.insert(a2);
-			a2++;
-		}
-	}
+	for (const light_edge& e : graph.Eall)
+		info.add_arc(e.src, e.dst, e.cost, e.is_tolled ? e.index : -1);
 
 	return info;
 }
@@ -1,29 +1,71 @@
 #pragma once
 
 #include <vector>
-#include <set>
-#include <map>
-#include <boost/bimap.hpp>
+#include <unordered_map>
+#include <ostream>
+#include <cstdint>
 #include "../../typedef.h"
 #include "../../graph/light_graph.h"
 
 struct problem;
+struct distance_oracle;
+
+// Set of dense non-negative ids (validity flags), iterated in increasing order
+struct index_set {
+	struct iterator {
+		const std::vector<char>* flags;
+		int i;
+
+		int operator*() const { return i; }
+		iterator& operator++() {
+			do i++; while (i < (int)flags->size() && !(*flags)[i]);
+			return *this;
+		}
+
+		// Erasing the current id while iterating may shrink the flags, so all iterators past them are equal
+		bool at_end() const { return i >= (int)flags->size(); }
+		bool operator==(const iterator& other) const { return at_end() ? other.at_end() : i == other.i; }
+		bool operator!=(const iterator& other) const { return !(*this == other); }
+	};
+
+	std::vector<char> flags;
+	int num;
+
+	index_set() : num(0) {}
+
+	void insert(int i);
+	void erase(int i);
+	void clear() { flags.clear(); num = 0; }
+
+	int count(int i) const { return i >= 0 && i < (int)flags.size() && flags[i]; }
+	int size() const { return num; }
+	bool empty() const { return num == 0; }
+
+	// Largest id + 1 (0 if empty)
+	int bound() const { return flags.size(); }
+
+	iterator begin() const;
+	iterator end() const { return iterator{ &flags, bound() }; }
+};
 
 struct preprocess_info {
-	using iset = std::set<int>;
 	using arc = std::pair<int, int>;
-	using arc_bimap = boost::bimap<int, arc>;
-	using arc_bimap_rel = arc_bimap::value_type;
 
-	template <typename value_type>
-	using imap = std::map<int, value_type>;
+	// V keeps the node ids of the graph, A1 the toll indices of the problem, A and A2 are local
+	// Removed ids keep their data until clean(), which renumbers A and A2 compactly
+	index_set V, A, A1, A2;
 
-	iset V, A, A1, A2;
+	// Indexed by a, a1 and a2 respectively
+	std::vector<arc> arc_A, arc_A1, arc_A2;
+	std::vector<cost_type> cost_A, cost_A1, cost_A2;
+	std::vector<char> is_tolled;
 
-	arc_bimap bimap_A, bimap_A1, bimap_A2;
+	// Nodes (after the source) of the original path replaced by an arc, for shortcut arcs only (sparse, off the hot paths)
+	std::unordered_map<int, std::vector<int>> expansion;
 
-	imap<cost_type> cost_A, cost_A1, cost_A2;
-	imap<bool> is_tolled;
+	// Add an arc (tolled if a1 >= 0), returns its index a
+	int add_arc(int src, int dst, cost_type cost, int a1 = -1);
+	bool has_arc(int src, int dst) const { return arc_index.count(arc_key(src, dst)); }
 
 	// Conversion
 	int a_to_a1(int a) const;
@@ -35,14 +77,35 @@ struct preprocess_info {
 	int src_dst_to_a1(int src, int dst) const;
 	int src_dst_to_a2(int src, int dst) const;
 
+	// Map a path of the processed graph back to the original graph
+	std::vector<int> expand_path(const std::vector<int>& path) const;
+
 	void prune(int orig, int dest);
 	void reduce(int orig, int dest);
 	void clean();
 
 	light_graph build_graph();
+
+private:
+	// A1 or A2 index of each arc, and the inverse maps
+	std::vector<int> a_to_sub, a1_to_a_index, a2_to_a_index;
+
+	// (src, dst) to a
+	std::unordered_map<uint64_t, int> arc_index;
+
+	static uint64_t arc_key(int src, int dst) { return (uint64_t)(uint32_t)src << 32 | (uint32_t)dst; }
+	void set_arc(int a, int src, int dst);
 };
 
 struct preprocessor {
+	// Per-commodity report (redirected when commodities are preprocessed concurrently)
+	std::ostream* log;
+
+	// Shared distances of the problem graph (optional, must belong to the preprocessed problem)
+	distance_oracle* oracle;
+
+	preprocessor();
+
 	preprocess_info preprocess(const problem& prob, int k);
 	virtual preprocess_info preprocess_impl(const light_graph& graph, const commodity& comm, int k = -1);
 };
@@ -4,8 +4,13 @@
 #include "formulations/null_formulation.h"
 #include "formulations/general_formulation.h"
 #include "formulations/standard_formulation.h"
+#include "formulations/value_func_formulation.h"
 #include "preprocessors/spgm_preprocessor.h"
+#include "preprocessors/skeleton_preprocessor.h"
 #include "formulations/sstd_formulation.h"
+#include "formulations/vfpath_oracle_formulation.h"
+#include "../graph/bilevel_path_enumerator.h"
+#include "../utilities/thread_pool.h"
 
 #include <iostream>
 #include <sstream>
@@ -26,15 +31,21 @@ map<string, string> composed_hmodel::VALID_CODES = {
 	{"vfcs2", "Value Function Complementary Slackness - Substitution"},
 	{"pcs2", "Path Complementary Slackness - Substitution"},
 	{"spgm", "SPGM-processed Standard"},
-	{"sstd", "SPGM-optional Standard"}
+	{"sstd", "SPGM-optional Standard"},
+	{"pvfo", "Path Value Function with Oracle Cuts"},
+	{"skel", "Skeleton Standard"},
+	{"vfskel", "Skeleton Value Function"}
 };
 map<string, string> composed_hmodel::VALID_FALLBACK = {
 	{"ustd", "Unprocessed Standard"},
-	{"spgm", "SPGM-processed Standard"}
+	{"spgm", "SPGM-processed Standard"},
+	{"skel", "Skeleton Standard"},
+	{"vfskel", "Skeleton Value Function"}
 };
 
 composed_hmodel::composed_hmodel(IloEnv& env, const problem& prob, const std::string& code) :
-	hybrid_model(env, prob), code(code), pre_spgm(false)
+	hybrid_model(env, prob), code(code), pre_spgm(false),
+	enum_time_limit(0), enum_memory_limit(0)
 {
 	stringstream ss(code);
 	string token;
@@ -72,6 +83,7 @@ composed_hmodel::composed_hmodel(IloEnv& env, const problem& prob, const std::st
 vector<formulation*> composed_hmodel::assign_formulations()
 {
 	int filtered_count = 0;
+	int over_budget_count = 0;
 	vector<int> counts(form_codes.size(), 0);
 	vector<string> form_names(form_codes.size());
 
@@ -83,62 +95,146 @@ vector<formulation*> composed_hmodel::assign_formulations()
 	form_names.back() = VALID_FALLBACK.at(form_codes.back());
 
 	std::vector<formulation*> all_forms(K);
-	spgm_preprocessor spgm_preproc;
 
-	LOOP(k, K) {
+	// Commodities are classified concurrently, the results are gathered in commodity order
+	const int FILTERED = -1;
+	vector<int> form_index(K);
+	vector<char> over_budget(K, false);		// Not vector<bool>, the tasks write concurrently
+	vector<string> logs(K);
+
+	auto assign = [&](int k) {
 		light_graph* graph;
 
 		if (pre_spgm) {
+			ostringstream log;
+			spgm_preprocessor spgm_preproc;
+			spgm_preproc.log = &log;
+			spgm_preproc.oracle = &distances;
+
 			auto info = spgm_preproc.preprocess(prob, k);
 			graph = new light_graph(info.build_graph());
+			logs[k] = log.str();
 		}
 		else {
 			graph = new light_graph(prob.graph);
 		}
-		auto paths = graph->bilevel_feasible_paths_2(prob.commodities[k].origin,
-													 prob.commodities[k].destination,
-													 break_points.empty() ? 2 : (break_points.back() + 1));
 
-		if (paths.size() <= 1) {
+		// Paths are pulled lazily, only as far as the next break point
+		// A cached enumeration is a prefix of the enumeration, which resumes past it if needed
+		bilevel_path_enumerator enumerator(*graph, prob.commodities[k].origin, prob.commodities[k].destination);
+		vector<vector<int>> paths;
+		bool complete = false;
+		int enumerated = 0;
+
+		if (paths_cache.enabled() && !paths_cache.load("bfp2", k, pre_spgm, paths, complete)) {
+			paths.clear();
+			complete = false;
+		}
+		const int cached_count = paths.size();
+
+		auto pull = [&](int count) {
+			if ((int)paths.size() >= count || complete)
+				return true;
+
+			auto more = enumerator.take(bilevel_path_enumerator::budget{
+				count - enumerated, enum_time_limit, enum_memory_limit });
+			int skipped = paths.size() - enumerated;
+			enumerated += more.size();
+			if ((int)more.size() > skipped)
+				paths.insert(paths.end(), std::make_move_iterator(more.begin() + skipped), std::make_move_iterator(more.end()));
+			complete = enumerator.exhausted();
+
+			// Stopped by the budget: the path set is incomplete
+			return (int)paths.size() >= count || complete;
+		};
+
+		bool within_budget = pull(2);
+
+		if (paths.size() <= 1 && within_budget) {
 			all_forms[k] = new null_formulation();
-			filtered_count++;
+			form_index[k] = FILTERED;
 		}
 		else {
-			auto it = std::find_if(break_points.begin(), break_points.end(),
-								   [&](int point) {
-									   return paths.size() <= point;
-								   });
+			auto it = break_points.begin();
+			for (; within_budget && it != break_points.end(); ++it) {
+				within_budget = pull(*it + 1);
+				if (within_budget && (int)paths.size() <= *it)
+					break;
+			}
+
+			if (!within_budget) {
+				it = break_points.end();
+				over_budget[k] = true;
+			}
+
+			int i = std::distance(break_points.begin(), it);
+			const string& form_code = form_codes[i];
 
 			// Fallback
 			if (it == break_points.end()) {
-				string& form_code = form_codes.back();
 				if (form_code == "ustd")
 					all_forms[k] = new standard_formulation();
 				else if(form_code == "spgm")
 					all_forms[k] = new standard_formulation(new spgm_preprocessor());
+				else if (form_code == "skel")
+					all_forms[k] = new standard_formulation(new skeleton_preprocessor());
+				else if (form_code == "vfskel")
+					all_forms[k] = new value_func_formulation(new skeleton_preprocessor());
 				else
 					throw runtime_error("fallback code " + form_code + " is not supported");
-				counts.back()++;
 			}
 			// General
 			else {
-				int i = std::distance(break_points.begin(), it);
-				string& form_code = form_codes[i];
 				if (form_code == "spgm")
 					all_forms[k] = new standard_formulation(new spgm_preprocessor());
 				else if (form_code == "sstd")
 					all_forms[k] = new sstd_formulation(paths, *graph);
+				else if (form_code == "pvfo")
+					all_forms[k] = new vfpath_oracle_formulation(pre_spgm ? vector<vector<int>>() : paths);	// Complete here
+				else if (form_code == "skel")
+					all_forms[k] = new standard_formulation(new skeleton_preprocessor());
+				else if (form_code == "vfskel")
+					all_forms[k] = new value_func_formulation(new skeleton_preprocessor());
 				else
 					all_forms[k] = new general_formulation(paths, *graph, form_code);
-				counts[i]++;
 			}
+			form_index[k] = i;
+		}
+
+		if (paths_cache.enabled()) {
+			if ((int)paths.size() > cached_count || (complete && enumerated > 0))
+				paths_cache.store("bfp2", k, pre_spgm, paths, complete);
+			if (enumerated > 0)
+				paths_cache.misses++;
+			else
+				paths_cache.hits++;
 		}
 
 		delete graph;
+	};
+
+	if (prep_threads > 1) {
+		thread_pool pool(prep_threads);
+		pool.run(K, assign);
+	}
+	else {
+		LOOP(k, K) assign(k);
+	}
+
+	LOOP(k, K) {
+		cout << logs[k];
+		if (form_index[k] == FILTERED)
+			filtered_count++;
+		else
+			counts[form_index[k]]++;
+		if (over_budget[k])
+			over_budget_count++;
 	}
 
 	cout << "CODE: " << code << endl;
 	cout << "Filtered: " << filtered_count << endl;
+	if (enum_time_limit > 0 || enum_memory_limit > 0)
+		cout << "Over enumeration budget: " << over_budget_count << endl;
 	for (int i = 0; i < form_codes.size(); i++) {
 		cout << form_names[i] << ": " << counts[i] << endl;
 	}
@@ -146,8 +242,27 @@ vector<formulation*> composed_hmodel::assign_formulations()
 	return all_forms;
 }
 
+std::string composed_hmodel::get_report()
+{
+	// Oracle statistics of the oracle path formulations
+	int outside_pool_hits = 0;
+	for (formulation* f : all_formulations) {
+		auto* pvfo = dynamic_cast<vfpath_oracle_formulation*>(f);
+		if (pvfo)
+			outside_pool_hits += pvfo->outside_pool_hits;
+	}
+
+	ostringstream ss;
+	ss << hybrid_model::get_report();
+	if (std::count(form_codes.begin(), form_codes.end(), "pvfo"))
+		ss << "ORACLE: " << outside_pool_hits << " callback hits outside the pool" << endl;
+	return ss.str();
+}
+
 void composed_hmodel::config(const model_config& conf)
 {
 	hybrid_model::config(conf);
 	pre_spgm = conf.pre_spgm;
+	enum_time_limit = conf.enum_time_limit / 1000.0;
+	enum_memory_limit = (size_t)conf.enum_memory_limit << 20;
 }
\ No newline at end of file
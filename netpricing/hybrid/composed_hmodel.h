@@ -13,6 +13,10 @@ struct composed_hmodel : public hybrid_model {
 
 	bool pre_spgm;
 
+	// Path enumeration budget per commodity (0 = no limit), commodities exceeding it fall back
+	double enum_time_limit;
+	size_t enum_memory_limit;
+
 	static std::map<std::string, std::string> VALID_CODES;
 	static std::map<std::string, std::string> VALID_FALLBACK;
 
@@ -21,5 +25,7 @@ struct composed_hmodel : public hybrid_model {
 	// Inherited via hybrid_model
 	virtual std::vector<formulation*> assign_formulations() override;
 
+	virtual std::string get_report() override;
+
 	virtual void config(const model_config& conf) override;
 };
\ No newline at end of file
@@ -21,9 +21,7 @@ vector<formulation*> filtered_hmodel<alternative>::assign_formulations()
 
 	std::vector<formulation*> all_forms(K);
 	LOOP(k, K) {
-		auto paths = lgraph.bilevel_feasible_paths(prob.commodities[k].origin,
-												   prob.commodities[k].destination,
-												   2);
+		auto paths = cached_bilevel_feasible_paths(lgraph, k, 2);
 		if (paths.size() <= 1) {
 			all_forms[k] = new null_formulation();
 			filtered_count++;
@@ -18,17 +18,21 @@ arc_path_standard_formulation::~arc_path_standard_formulation()
 {
 }
 
-void arc_path_standard_formulation::formulate_impl()
+void arc_path_standard_formulation::prepare_impl()
 {
-	// Prepare the solver
-	prepare();
+	path_based_formulation::prepare_impl();
+
+	preproc.log = &prep_log;
 	info = preproc.preprocess(*prob, k);
-	V = *(info.V.rbegin()) + 1;
-	A = *(info.A.rbegin()) + 1;
-	A1 = *(info.A1.rbegin()) + 1;
-	A2 = *(info.A2.rbegin()) + 1;
+	V = info.V.bound();
+	A = info.A.bound();
+	A1 = info.A1.bound();
+	A2 = info.A2.bound();
 	lgraph = new light_graph(info.build_graph());
+}
 
+void arc_path_standard_formulation::formulate_impl()
+{
 	// Variables
 	z = VarArray(env, P, 0, 1, ILOBOOL);
 	lambda = VarArray(env, V, -IloInfinity, IloInfinity);
@@ -51,7 +55,7 @@ void arc_path_standard_formulation::formulate_impl()
 	// Dual feasibility
 	dual_feas = RangeArray(env, A);
 	LOOP_INFO(a, A) {
-		auto arc = info.bimap_A.left.at(a);
+		auto arc = info.arc_A[a];
 		bool is_tolled = info.is_tolled.at(a);
 		cost_type cost = info.cost_A.at(a);
 
@@ -139,7 +143,7 @@ std::vector<std::pair<IloNumVar, IloNum>> arc_path_standard_formulation::path_to
 
 	// Set toll
 	LOOP_INFO(a, A1) {
-		auto arc = info.bimap_A1.left.at(a);
+		auto arc = info.arc_A1[a];
 		lgraph->edge(arc).toll = tvals[a];
 	}
 
@@ -28,6 +28,7 @@ struct arc_path_standard_formulation : public path_based_formulation {
 	arc_path_standard_formulation(const std::vector<path>& paths);
 	virtual ~arc_path_standard_formulation();
 
+	virtual void prepare_impl() override;
 	virtual void formulate_impl() override;
 	virtual std::vector<IloNumVar> get_all_variables() override;
 	virtual IloExpr get_obj_expr() override;
@@ -18,17 +18,21 @@ arc_path_value_func_formulation::~arc_path_value_func_formulation()
 {
 }
 
-void arc_path_value_func_formulation::formulate_impl()
+void arc_path_value_func_formulation::prepare_impl()
 {
-	// Prepare the solver
-	prepare();
+	path_based_formulation::prepare_impl();
+
+	preproc.log = &prep_log;
 	info = preproc.preprocess(*prob, k);
-	V = *(info.V.rbegin()) + 1;
-	A = *(info.A.rbegin()) + 1;
-	A1 = *(info.A1.rbegin()) + 1;
-	A2 = *(info.A2.rbegin()) + 1;
+	V = info.V.bound();
+	A = info.A.bound();
+	A1 = info.A1.bound();
+	A2 = info.A2.bound();
 	lgraph = new light_graph(info.build_graph());
+}
 
+void arc_path_value_func_formulation::formulate_impl()
+{
 	// Variables
 	z = VarArray(env, P, 0, 1, ILOBOOL);
 	tx = VarArray(env, A1, 0, IloInfinity);
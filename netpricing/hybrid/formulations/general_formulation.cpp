@@ -62,15 +62,16 @@ general_formulation::~general_formulation()
 	delete lgraph;
 }
 
-void general_formulation::prepare()
+void general_formulation::prepare_impl()
 {
 	// Preprocessing
+	preproc.log = &prep_log;
 	info = preproc.preprocess_impl(original, prob->commodities[k], k);
 
-	V = *(info.V.rbegin()) + 1;
-	A = *(info.A.rbegin()) + 1;
-	A1 = *(info.A1.rbegin()) + 1;
-	A2 = *(info.A2.rbegin()) + 1;
+	V = info.V.bound();
+	A = info.A.bound();
+	A1 = info.A1.bound();
+	A2 = info.A2.bound();
 	lgraph = new light_graph(info.build_graph());
 
 	// Process path
@@ -90,7 +91,7 @@ void general_formulation::prepare()
 
 		// Extract arc sets
 		for (int i = 0; i < paths[p].size() - 1; i++) {
-			int a = info.bimap_A.right.at(make_pair(paths[p][i], paths[p][i + 1]));
+			int a = info.src_dst_to_a(paths[p][i], paths[p][i + 1]);
 			arc_sets[p].insert(a);
 		}
 	}
@@ -100,7 +101,7 @@ void general_formulation::prepare()
 
 	// Add a little penalty to favor path with fewest arcs
 	/*LOOP_INFO(a, A2) {
-		auto arc = info.bimap_A2.left.at(a);
+		auto arc = info.arc_A2[a];
 		lgraph->edge(arc).toll = TOLLFREE_PENALTY;
 	}*/
 }
@@ -112,9 +113,6 @@ bool general_formulation::check_model(space primal, space dual, opt_condition co
 
 void general_formulation::formulate_impl()
 {
-	// Prepare
-	prepare();
-
 	// VARIABLES
 	// Primal Arc
 	if (primal_space == ARC) {
@@ -180,12 +178,12 @@ void general_formulation::formulate_impl()
 
 		// Flow matrix
 		LOOP_INFO(a, A1) {
-			auto arc = info.bimap_A1.left.at(a);
+			auto arc = info.arc_A1[a];
 			flow_constr[arc.first].setLinearCoef(x[a], 1);
 			flow_constr[arc.second].setLinearCoef(x[a], -1);
 		}
 		LOOP_INFO(a, A2) {
-			auto arc = info.bimap_A2.left.at(a);
+			auto arc = info.arc_A2[a];
 			flow_constr[arc.first].setLinearCoef(y[a], 1);
 			flow_constr[arc.second].setLinearCoef(y[a], -1);
 		}
@@ -203,7 +201,7 @@ void general_formulation::formulate_impl()
 	if (dual_space == ARC) {
 		dual_feas = RangeArray(env, A, -IloInfinity, 0);
 		LOOP_INFO(a, A) {
-			auto arc = info.bimap_A.left.at(a);
+			auto arc = info.arc_A[a];
 			bool is_tolled = info.is_tolled.at(a);
 			cost_type cost = info.cost_A.at(a);
 
@@ -308,14 +306,14 @@ void general_formulation::formulate_impl()
 
 			// Set toll to max
 			LOOP_INFO(a, A1) {
-				auto arc = info.bimap_A1.left.at(a);
+				auto arc = info.arc_A1[a];
 				lgraph->edge(arc).toll = prob->big_n[a];
 			}
 			vector<cost_type> lambda_ub = lgraph->price_to_dst(prob->commodities[k].destination);
 
 			// Set toll to 0
 			LOOP_INFO(a, A1) {
-				auto arc = info.bimap_A1.left.at(a);
+				auto arc = info.arc_A1[a];
 				lgraph->edge(arc).toll = 0;
 			}
 			vector<cost_type> lambda_lb = lgraph->price_to_dst(prob->commodities[k].destination);
@@ -323,7 +321,7 @@ void general_formulation::formulate_impl()
 			// Formulation
 			comp_slack = RangeArray(env, A, 0, IloInfinity);
 			LOOP_INFO(a, A) {
-				auto arc = info.bimap_A.left.at(a);
+				auto arc = info.arc_A[a];
 				bool is_tolled = info.is_tolled.at(a);
 				cost_type cost = info.cost_A.at(a);
 
@@ -419,12 +417,12 @@ std::vector<int> general_formulation::get_optimal_path()
 		// Src-dst map
 		multimap<int, int> src_dst_map;
 		LOOP_INFO(a, A1) {
-			auto arc = info.bimap_A1.left.at(a);
+			auto arc = info.arc_A1[a];
 			if (model->cplex.getValue(x[a]) > 0.5)
 				src_dst_map.emplace(arc.first, arc.second);
 		}
 		LOOP_INFO(a, A2) {
-			auto arc = info.bimap_A2.left.at(a);
+			auto arc = info.arc_A2[a];
 			if (model->cplex.getValue(y[a]) > 0.5)
 				src_dst_map.emplace(arc.first, arc.second);
 		}
@@ -478,7 +476,7 @@ std::vector<std::pair<IloNumVar, IloNum>> general_formulation::path_to_solution(
 
 	// Find the shortest path
 	LOOP_INFO(a, A1) {
-		auto arc = info.bimap_A1.left.at(a);
+		auto arc = info.arc_A1[a];
 		lgraph->edge(arc).toll = tvals[a] * TOLL_PREFERENCE;		// Prefer tolled arcs
 	}
 	auto path = lgraph->shortest_path(prob->commodities[k].origin, prob->commodities[k].destination);
@@ -495,7 +493,7 @@ std::vector<std::pair<IloNumVar, IloNum>> general_formulation::path_to_solution(
 
 		// Select the arcs in the path
 		for (int i = 0; i < path.size() - 1; i++) {
-			int a = info.bimap_A.right.at(make_pair(path[i], path[i + 1]));
+			int a = info.src_dst_to_a(path[i], path[i + 1]);
 			bool is_tolled = info.is_tolled.at(a);
 			if (is_tolled) sol.at(x[info.a_to_a1(a)]) = 1;
 			else sol.at(y[info.a_to_a2(a)]) = 1;
@@ -508,7 +506,7 @@ std::vector<std::pair<IloNumVar, IloNum>> general_formulation::path_to_solution(
 
 	// Set toll to original values
 	LOOP_INFO(a, A1) {
-		auto arc = info.bimap_A1.left.at(a);
+		auto arc = info.arc_A1[a];
 		lgraph->edge(arc).toll = tvals[a];
 	}
 
@@ -551,12 +549,12 @@ void general_formulation::invoke_callback(const IloCplex::Callback::Context& con
 	// Src-dst map
 	multimap<int, int> src_dst_map;
 	LOOP_INFO(a, A1) {
-		auto arc = info.bimap_A1.left.at(a);
+		auto arc = info.arc_A1[a];
 		if (context.getCandidateValue(x[a]) > 0.5)
 			src_dst_map.emplace(arc.first, arc.second);
 	}
 	LOOP_INFO(a, A2) {
-		auto arc = info.bimap_A2.left.at(a);
+		auto arc = info.arc_A2[a];
 		if (context.getCandidateValue(y[a]) > 0.5)
 			src_dst_map.emplace(arc.first, arc.second);
 	}
@@ -590,17 +588,17 @@ void general_formulation::invoke_callback(const IloCplex::Callback::Context& con
 
 		cost_type big_m = path_null_cost - null_costs[0];
 		for (auto& arc : path_toll_set) {
-			big_m += prob->big_n[info.bimap_A1.right.at(arc)];
+			big_m += prob->big_n[info.src_dst_to_a1(arc.first, arc.second)];
 		}
 
 		// Cut Formulation
 		IloRange cut(env, 0, IloInfinity);
 
 		cut.setLinearCoef(lk, 1);
-		for (auto& arc : path_toll_set) cut.setLinearCoef(t[info.bimap_A1.right.at(arc)], -1);
+		for (auto& arc : path_toll_set) cut.setLinearCoef(t[info.src_dst_to_a1(arc.first, arc.second)], -1);
 
 		for (auto& arc : src_dst_map) {
-			int a = info.bimap_A.right.at(arc);
+			int a = info.src_dst_to_a(arc.first, arc.second);
 			if (info.is_tolled.at(a)) cut.setLinearCoef(x[info.a_to_a1(a)], -big_m);
 			else cut.setLinearCoef(y[info.a_to_a2(a)], -big_m);
 		}
@@ -58,7 +58,7 @@ struct general_formulation : public formulation {
 	path_preprocessor preproc;
 	preprocess_info info;
 	light_graph original;
-	light_graph* lgraph;
+	light_graph* lgraph = nullptr;
 
 	// Path attributes
 	using path = std::vector<int>;
@@ -76,7 +76,7 @@ struct general_formulation : public formulation {
 	general_formulation(const std::vector<path>& paths, const light_graph& original, const std::string& code);
 	virtual ~general_formulation();
 
-	virtual void prepare();
+	virtual void prepare_impl() override;
 	bool check_model(space primal, space dual, opt_condition condition);
 
 	virtual void formulate_impl() override;
@@ -14,7 +14,7 @@ path_based_formulation::~path_based_formulation()
 {
 }
 
-void path_based_formulation::prepare()
+void path_based_formulation::prepare_impl()
 {
 	light_graph lgraph(prob->graph);
 
@@ -17,5 +17,5 @@ struct path_based_formulation : public formulation {
 	path_based_formulation(const std::vector<path>& paths);
 	virtual ~path_based_formulation();
 
-	void prepare();
+	virtual void prepare_impl() override;
 };
\ No newline at end of file
@@ -19,9 +19,6 @@ path_didi_formulation::~path_didi_formulation()
 
 void path_didi_formulation::formulate_impl()
 {
-	// Prepare the solver
-	prepare();
-
 	// Variables
 	z = VarArray(env, P, 0, 1, ILOBOOL);
 	tk = IloNumVar(env);
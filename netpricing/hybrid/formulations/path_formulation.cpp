@@ -44,9 +44,6 @@ IloRange path_formulation::get_cut(int curr_p, int opt_p)
 
 void path_formulation::formulate_impl()
 {
-	// Prepare the solver
-	prepare();
-
 	// Variables
 	z = VarArray(env, P, 0, 1, ILOBOOL);
 	tz = VarMatrix(env, P);
@@ -1,16 +1,18 @@
 #include "processed_formulation.h"
 
+#include "../base/hybrid_model.h"
 #include "../../macros.h"
 
 using namespace std;
 
-processed_formulation::processed_formulation()
+processed_formulation::processed_formulation() :
+	lgraph(nullptr)
 {
 	preproc = new preprocessor();	// Default preprocessor
 }
 
 processed_formulation::processed_formulation(preprocessor* _preproc) :
-	preproc(_preproc)
+	preproc(_preproc), lgraph(nullptr)
 {
 }
 
@@ -20,22 +22,28 @@ processed_formulation::~processed_formulation()
 	delete lgraph;
 }
 
-void processed_formulation::preprocess()
+void processed_formulation::prepare_impl()
 {
+	preproc->log = &prep_log;
+	preproc->oracle = &model->distances;
 	info = preproc->preprocess(*prob, k);
-	V = *(info.V.rbegin()) + 1;
-	A = *(info.A.rbegin()) + 1;
-	A1 = *(info.A1.rbegin()) + 1;
-	A2 = *(info.A2.rbegin()) + 1;
+	V = info.V.bound();
+	A = info.A.bound();
+	A1 = info.A1.bound();
+	A2 = info.A2.bound();
 
 	lgraph = new light_graph(info.build_graph());
+	lgraph->search = light_graph::ASTAR;
+
+	// Cache the potential, concurrent callbacks only read it afterwards
+	lgraph->potential(prob->commodities[k].destination);
 }
 
 std::vector<int> processed_formulation::get_path(const NumArray& tvals)
 {
 	// Set toll
 	LOOP_INFO(a, A1) {
-		auto arc = info.bimap_A1.left.at(a);
+		auto arc = info.arc_A1[a];
 		lgraph->edge(arc).toll = tvals[a] * TOLL_PREFERENCE;		// Prefer tolled arcs
 	}
 
@@ -20,7 +20,7 @@ struct processed_formulation : public formulation {
 
 	virtual ~processed_formulation();
 
-	void preprocess();
+	virtual void prepare_impl() override;
 
 	std::vector<int> get_path(const NumArray& tvals);
 };
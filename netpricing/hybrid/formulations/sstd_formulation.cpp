@@ -9,9 +9,11 @@ sstd_formulation::sstd_formulation(const vector<path>& paths, const light_graph&
 {
 }
 
-void sstd_formulation::prepare()
+void sstd_formulation::prepare_impl()
 {
 	// Normal preprocessing
+	preproc.log = &prep_log;
+	spgm_preproc.log = &prep_log;
 	info = preproc.preprocess_impl(original, prob->commodities[k], k);
 	lgraph = new light_graph(info.build_graph());
 
@@ -19,14 +21,15 @@ void sstd_formulation::prepare()
 	preprocess_info info_spgm = spgm_preproc.preprocess_impl(*lgraph, prob->commodities[k], k);
 	if (info_spgm.A.size() < info.A.size()) {
 		info = info_spgm;
+		delete lgraph;
 		lgraph = new light_graph(info_spgm.build_graph());
-		cout << "Comm " << k << " (SSTD): SPGM applied" << endl;
+		prep_log << "Comm " << k << " (SSTD): SPGM applied" << endl;
 	}
 
-	V = *(info.V.rbegin()) + 1;
-	A = *(info.A.rbegin()) + 1;
-	A1 = *(info.A1.rbegin()) + 1;
-	A2 = *(info.A2.rbegin()) + 1;
+	V = info.V.bound();
+	A = info.A.bound();
+	A1 = info.A1.bound();
+	A2 = info.A2.bound();
 
 	// Process path
 	toll_sets.resize(P);
@@ -45,7 +48,7 @@ void sstd_formulation::prepare()
 
 		// Extract arc sets
 		for (int i = 0; i < paths[p].size() - 1; i++) {
-			int a = info.bimap_A.right.at(make_pair(paths[p][i], paths[p][i + 1]));
+			int a = info.src_dst_to_a(paths[p][i], paths[p][i + 1]);
 			arc_sets[p].insert(a);
 		}
 	}
@@ -10,5 +10,5 @@ struct sstd_formulation : public general_formulation {
 
 	sstd_formulation(const std::vector<path>& paths, const light_graph& original);
 
-	virtual void prepare() override;
+	virtual void prepare_impl() override;
 };
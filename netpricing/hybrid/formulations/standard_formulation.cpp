@@ -22,8 +22,6 @@ standard_formulation::~standard_formulation()
 
 void standard_formulation::formulate_impl()
 {
-	preprocess();
-
 	// Variables
 	x = VarArray(env, A1, 0, 1, ILOBOOL);
 	y = VarArray(env, A2, 0, IloInfinity);
@@ -47,12 +45,12 @@ void standard_formulation::formulate_impl()
 
 	// Flow matrix
 	LOOP_INFO(a, A1) {
-		auto arc = info.bimap_A1.left.at(a);
+		auto arc = info.arc_A1[a];
 		flow_constr[arc.first].setLinearCoef(x[a], 1);
 		flow_constr[arc.second].setLinearCoef(x[a], -1);
 	}
 	LOOP_INFO(a, A2) {
-		auto arc = info.bimap_A2.left.at(a);
+		auto arc = info.arc_A2[a];
 		flow_constr[arc.first].setLinearCoef(y[a], 1);
 		flow_constr[arc.second].setLinearCoef(y[a], -1);
 	}
@@ -60,7 +58,7 @@ void standard_formulation::formulate_impl()
 	// Dual feasibility
 	dual_feas = RangeArray(env, A);
 	LOOP_INFO(a, A) {
-		auto arc = info.bimap_A.left.at(a);
+		auto arc = info.arc_A[a];
 		bool is_tolled = info.is_tolled.at(a);
 		cost_type cost = info.cost_A.at(a);
 
@@ -149,7 +147,7 @@ std::vector<std::pair<IloNumVar, IloNum>> standard_formulation::path_to_solution
 	// Set the variables of the edges in path to 1
 	for (int i = 0; i < path.size() - 1; i++) {
 		auto arc = make_pair(path[i], path[i + 1]);
-		int a = info.bimap_A.right.at(arc);
+		int a = info.src_dst_to_a(arc.first, arc.second);
 		bool is_tolled = info.is_tolled.at(a);
 
 		if (is_tolled) {
@@ -163,7 +161,7 @@ std::vector<std::pair<IloNumVar, IloNum>> standard_formulation::path_to_solution
 
 	// Set toll to true values
 	LOOP_INFO(a, A1) {
-		auto arc = info.bimap_A1.left.at(a);
+		auto arc = info.arc_A1[a];
 		lgraph->edge(arc).toll = tvals[a];
 	}
 
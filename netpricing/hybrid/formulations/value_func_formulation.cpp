@@ -43,7 +43,7 @@ IloRange value_func_formulation::get_cut(const std::vector<int>& path)
 	// Path-depending part
 	cut_rhs = path_cost;
 	for (const auto& pair : tset) {
-		int a1 = info.bimap_A1.right.at(pair);
+		int a1 = info.src_dst_to_a1(pair.first, pair.second);
 		cut_lhs.setLinearCoef(t[a1], -1);
 	}
 
@@ -52,8 +52,6 @@ IloRange value_func_formulation::get_cut(const std::vector<int>& path)
 
 void value_func_formulation::formulate_impl()
 {
-	preprocess();
-
 	// Variables
 	x = VarArray(env, A1, 0, 1, ILOBOOL);
 	y = VarArray(env, A2, 0, IloInfinity);
@@ -75,12 +73,12 @@ void value_func_formulation::formulate_impl()
 
 	// Flow matrix
 	LOOP_INFO(a, A1) {
-		auto arc = info.bimap_A1.left.at(a);
+		auto arc = info.arc_A1[a];
 		flow_constr[arc.first].setLinearCoef(x[a], 1);
 		flow_constr[arc.second].setLinearCoef(x[a], -1);
 	}
 	LOOP_INFO(a, A2) {
-		auto arc = info.bimap_A2.left.at(a);
+		auto arc = info.arc_A2[a];
 		flow_constr[arc.first].setLinearCoef(y[a], 1);
 		flow_constr[arc.second].setLinearCoef(y[a], -1);
 	}
@@ -147,7 +145,7 @@ std::vector<std::pair<IloNumVar, IloNum>> value_func_formulation::path_to_soluti
 	// Set the variables of the edges in path to 1
 	for (int i = 0; i < path.size() - 1; i++) {
 		auto arc = make_pair(path[i], path[i + 1]);
-		int a = info.bimap_A.right.at(arc);
+		int a = info.src_dst_to_a(arc.first, arc.second);
 		bool is_tolled = info.is_tolled.at(a);
 
 		if (is_tolled) {
@@ -40,9 +40,6 @@ IloRange vfpath_formulation::get_cut(int target_p)
 
 void vfpath_formulation::formulate_impl()
 {
-	// Prepare the solver
-	prepare();
-
 	// Variables
 	z = VarArray(env, P, 0, 1, ILOBOOL);
 	tz = VarMatrix(env, P);
@@ -0,0 +1,125 @@
+#include "vfpath_oracle_formulation.h"
+
+#include "../base/hybrid_model.h"
+#include "../../macros.h"
+#include "../../graph/bilevel_path_enumerator.h"
+
+using namespace std;
+
+vfpath_oracle_formulation::vfpath_oracle_formulation(const std::vector<path>& paths) :
+	vfpath_formulation(paths, false),
+	graph(nullptr), outside_pool_hits(0)
+{
+}
+
+vfpath_oracle_formulation::~vfpath_oracle_formulation()
+{
+	delete graph;
+}
+
+void vfpath_oracle_formulation::prepare_impl()
+{
+	const commodity& comm = prob->commodities[k];
+
+	graph = new light_graph(prob->graph);
+	graph->search = light_graph::ASTAR;
+
+	// Pool: all the bilevel feasible paths, enumerated in one pass unless given (or cached complete)
+	if (paths.empty()) {
+		bool complete = false;
+		path_cache& cache = model->paths_cache;
+		if (!cache.enabled() || !cache.load("bfp2", k, false, paths, complete) || !complete) {
+			bilevel_path_enumerator enumerator(*graph, comm.origin, comm.destination);
+			paths = enumerator.take(0);
+			if (cache.enabled())
+				cache.store("bfp2", k, false, paths, true);
+		}
+	}
+
+	P = paths.size();
+	path_based_formulation::prepare_impl();
+
+	LOOP(p, P) pool_index.emplace(paths[p], p);
+
+	a1_to_index.resize(A1);
+	LOOP(a, A1) {
+		SRC_DST_FROM_A1(*prob, a);
+		a1_to_index[a] = graph->edge(src, dst).index;
+	}
+
+	// Cache the potential, the oracle only reads it afterwards
+	graph->potential(comm.destination);
+}
+
+vfpath_oracle_formulation::path vfpath_oracle_formulation::price(const NumArray& tvals) const
+{
+	// Local overlay, callbacks may run concurrently
+	light_graph::toll_overlay tolls(A1, 0);
+	LOOP(a, A1) tolls[a1_to_index[a]] = tvals[a] * TOLL_PREFERENCE;		// Prefer tolled arcs
+
+	const commodity& comm = prob->commodities[k];
+	return graph->shortest_path(light_workspace::local(), comm.origin, comm.destination, &tolls);
+}
+
+IloRange vfpath_oracle_formulation::get_oracle_cut(const path& target)
+{
+	// Cost of the chosen pool path <= cost of the target path
+	IloExpr cut_lhs(env);
+
+	LOOP(p, P) {
+		cut_lhs.setLinearCoef(z[p], null_costs[p]);
+		for (int a : toll_sets[p])
+			cut_lhs.setLinearCoef(tz[p][a], 1);
+	}
+
+	for (const auto& pair : graph->get_toll_list(target)) {
+		auto edge = EDGE_FROM_SRC_DST(*prob, pair.first, pair.second);
+		cut_lhs.setLinearCoef(t[EDGE_TO_A1(*prob, edge)], -1);
+	}
+
+	return cut_lhs <= graph->get_path_cost(target, false);
+}
+
+bool vfpath_oracle_formulation::can_represent(const std::vector<int>& path)
+{
+	return pool_index.count(path);
+}
+
+void vfpath_oracle_formulation::invoke_callback(const IloCplex::Callback::Context& context, const NumArray& tvals)
+{
+	// Oracle: best response on the whole graph
+	cb_opt_path = price(tvals);
+
+	auto it = pool_index.find(cb_opt_path);
+	if (it != pool_index.end())
+		cb_opt_p = it->second;
+	else {
+		cb_opt_p = -1;
+		outside_pool_hits++;
+	}
+
+	// Optimal objective
+	cb_opt_toll = 0;
+	for (const auto& pair : graph->get_toll_list(cb_opt_path)) {
+		auto edge = EDGE_FROM_SRC_DST(*prob, pair.first, pair.second);
+		cb_opt_toll += tvals[EDGE_TO_A1(*prob, edge)];
+	}
+
+	// Add the cut if it is violated
+	IloRange cut = get_oracle_cut(cb_opt_path);
+	double lhs_val = context.getCandidateValue(cut.getExpr());
+	if (lhs_val > cut.getUB() * (1 + TOLERANCE)) {
+		context.rejectCandidate(cut);
+	}
+
+	cut.end();
+}
+
+void vfpath_oracle_formulation::post_heuristic_cut(const IloCplex::Callback::Context& context, const NumArray& tvals,
+												   const std::vector<int>& path)
+{
+	// The cut is valid for any path of the graph, the pool holds every bilevel feasible path
+	IloRange cut = get_oracle_cut(path);
+	context.addUserCut(cut, IloCplex::CutManagement::UseCutFilter, false);
+	cut.end();
+}
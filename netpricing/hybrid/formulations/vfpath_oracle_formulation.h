@@ -0,0 +1,44 @@
+#pragma once
+
+#include "vfpath_formulation.h"
+#include "../../graph/light_graph.h"
+
+#include <map>
+#include <atomic>
+
+// Path value function formulation over the complete set of bilevel feasible paths, whose follower optimality is
+// checked by a shortest path oracle on the whole graph instead of a scan of the paths (no column generation)
+// The value function cuts compare the chosen path with any path of the graph, which is only valid for a complete pool
+// The pool is given by the caller (paths of the original graph) or enumerated in one pass during preparation
+struct vfpath_oracle_formulation : public vfpath_formulation {
+	// Oracle
+	light_graph* graph;
+	std::vector<int> a1_to_index;
+	std::map<path, int> pool_index;
+
+	// Best response of the last callback (cb_opt_p = -1 if it is outside the pool)
+	path cb_opt_path;
+
+	// Callback invocations whose best response is not a pool path (an equal cost tie with a pool path,
+	// as the pool is complete), counted per hit and not per distinct path
+	std::atomic<int> outside_pool_hits;
+
+	vfpath_oracle_formulation(const std::vector<path>& paths = {});
+	virtual ~vfpath_oracle_formulation();
+
+	path price(const NumArray& tvals) const;
+	IloRange get_oracle_cut(const path& target);
+
+	virtual void prepare_impl() override;
+
+	virtual bool can_represent(const std::vector<int>& path) override;
+
+	virtual bool has_callback() override { return true; }
+	virtual void invoke_callback(const IloCplex::Callback::Context& context, const NumArray& tvals) override;
+
+	virtual bool has_callback_optimal_path() override { return cb_opt_p >= 0; }
+
+	virtual bool has_heuristic_cut() override { return true; }
+	virtual void post_heuristic_cut(const IloCplex::Callback::Context& context, const NumArray& tvals,
+									const std::vector<int>& path) override;
+};
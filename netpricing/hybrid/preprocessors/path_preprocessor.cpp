@@ -3,6 +3,7 @@
 #include "../../problem.h"
 
 #include <iostream>
+#include <set>
 
 using namespace std;
 
@@ -27,33 +28,23 @@ preprocess_info path_preprocessor::preprocess_impl(const light_graph& graph, con
 		}
 	}
 
-	info.V = std::move(keep_V);
+	info.V.clear();
+	for (int i : keep_V)
+		info.V.insert(i);
 
-	for (auto it = info.A.begin(); it != info.A.end();) {
-		if (!keep_A.count(info.bimap_A.left.at(*it)))
-			it = info.A.erase(it);
-		else
-			it++;
-	}
-
-	for (auto it = info.A1.begin(); it != info.A1.end();) {
-		if (!keep_A.count(info.bimap_A1.left.at(*it)))
-			it = info.A1.erase(it);
-		else
-			it++;
-	}
+	for (int a : info.A) {
+		if (keep_A.count(info.arc_A[a]))
+			continue;
 
-	for (auto it = info.A2.begin(); it != info.A2.end();) {
-		if (!keep_A.count(info.bimap_A2.left.at(*it)))
-			it = info.A2.erase(it);
-		else
-			it++;
+		info.A.erase(a);
+		if (info.is_tolled[a]) info.A1.erase(info.a_to_a1(a));
+		else info.A2.erase(info.a_to_a2(a));
 	}
 
 	info.reduce(comm.origin, comm.destination);
 	info.clean();
 
-	cout << "Comm " << k << " (PATH): " << P << " paths, " << info.V.size() << " nodes, "
+	*log << "Comm " << k << " (PATH): " << P << " paths, " << info.V.size() << " nodes, "
 		<< info.A.size() << " arcs (" << info.A1.size() << " tolled)" << endl;
 
 	return info;
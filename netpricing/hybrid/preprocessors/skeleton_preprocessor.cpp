@@ -0,0 +1,120 @@
+#include "skeleton_preprocessor.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#include "../../problem.h"
+#include "../../macros.h"
+#include "../../utilities/distance_oracle.h"
+
+using namespace std;
+
+// Helper functions
+static void add_shortcut(preprocess_info& info, int& virt, int src, int dst, cost_type cost,
+						 const vector<int>& full_path)
+{
+	vector<int> expansion(full_path.begin() + 1, full_path.end());
+
+	// If there exists a tolled arc with the same (src, dst), go through a virtual node
+	if (info.has_arc(src, dst)) {
+		info.V.insert(virt);
+
+		int a = info.add_arc(virt, dst, 0);
+		info.expansion.emplace(a, vector<int>());
+		dst = virt++;
+	}
+
+	int a = info.add_arc(src, dst, cost);
+	info.expansion.emplace(a, std::move(expansion));
+}
+
+preprocess_info skeleton_preprocessor::preprocess_impl(const light_graph& graph, const commodity& comm, int k)
+{
+	// Trees are shared between commodities on the problem graph, computed on a copy otherwise
+	const bool shared = oracle && &graph == &oracle->graph;
+	light_graph original = shared ? light_graph(0) : preprocessor::preprocess_impl(graph, comm, k).build_graph();
+
+	int orig = comm.origin;
+	int dest = comm.destination;
+
+	// Bounds at zero tolls, and the toll-free O-D cost
+	vector<cost_type> lower_orig, lower_dest;
+	cost_type upper_total;
+	if (shared) {
+		lower_orig = oracle->price_from_src(orig, true);
+		lower_dest = oracle->price_to_dst(dest, true);
+		upper_total = oracle->price_from_src(orig, false)[dest];
+	}
+	else {
+		original.set_toll_arcs_enabled(true);
+		lower_orig = original.price_from_src(orig);
+		lower_dest = original.price_to_dst(dest);
+
+		original.set_toll_arcs_enabled(false);
+		upper_total = original.price_from_src(orig)[dest];
+	}
+
+	// Info
+	preprocess_info info;
+	LOOP(i, graph.V) info.V.insert(i);
+
+	// Skeleton nodes: shortcuts leave from heads (O and tolled arc ends) and enter tails (D and tolled arc starts)
+	vector<bool> is_head(graph.V, false), is_tail(graph.V, false);
+	is_head[orig] = true;
+	is_tail[dest] = true;
+
+	// Add the tolled arcs that can beat the toll-free path (rule #5 of SPGM)
+	for (const light_edge& e : graph.Eall) {
+		if (!e.is_tolled) continue;
+		if (upper_total <= lower_orig[e.src] + e.cost + lower_dest[e.dst]) continue;
+
+		info.add_arc(e.src, e.dst, e.cost, e.index);
+
+		is_tail[e.src] = true;
+		is_head[e.dst] = true;
+	}
+
+	// Add the toll-free shortcuts (toll arcs are still disabled)
+	int virt = graph.V;
+	vector<cost_type> local_distances;
+	vector<int> local_parents;
+
+	LOOP(u, graph.V) {
+		if (!is_head[u]) continue;
+
+		if (!shared)
+			original.dijkstra(u, local_distances, local_parents);
+		const vector<cost_type>& distances = shared ? oracle->from_src(u, false).distances : local_distances;
+		const vector<int>& parents = shared ? oracle->from_src(u, false).parents : local_parents;
+
+		LOOP(v, graph.V) {
+			if (!is_tail[v] || v == u || !isfinite(distances[v])) continue;
+
+			// Trace the path, it is dominated if it passes through another skeleton node
+			vector<int> full_path{ v };
+			bool dominated = false;
+			for (int curr = parents[v]; curr != u; curr = parents[curr]) {
+				if (is_head[curr] && is_tail[curr]) {
+					dominated = true;
+					break;
+				}
+				full_path.push_back(curr);
+			}
+			if (dominated) continue;
+
+			full_path.push_back(u);
+			std::reverse(full_path.begin(), full_path.end());
+
+			add_shortcut(info, virt, u, v, distances[v], full_path);
+		}
+	}
+
+	info.prune(orig, dest);
+	info.clean();
+
+	*log << "Comm " << k << " (SKEL): " << info.V.size() << " nodes, "
+		<< info.A.size() << " arcs (" << info.A1.size() << " tolled)" << endl;
+
+	return info;
+}
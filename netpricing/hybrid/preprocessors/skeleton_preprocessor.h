@@ -0,0 +1,12 @@
+#pragma once
+
+#include "../base/preprocessor.h"
+
+// Skeleton graph: origin, destination and tolled arc endpoints only,
+// connected by the tolled arcs and by toll-free shortest path shortcuts
+// A shortcut passing through another skeleton node is dominated (the two shortcuts chain to the same path)
+// Shortcuts keep their original path in preprocess_info::expansion
+struct skeleton_preprocessor : public virtual preprocessor {
+
+	virtual preprocess_info preprocess_impl(const light_graph& graph, const commodity& comm, int k = -1) override;
+};
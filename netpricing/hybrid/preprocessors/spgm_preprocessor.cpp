@@ -5,73 +5,62 @@
 
 #include "../../problem.h"
 #include "../../macros.h"
+#include "../../utilities/distance_oracle.h"
 
 using namespace std;
 
 // Helper functions
-void add_toll_free_arc(preprocess_info& info, int& a, int src, int dst, cost_type cost) {
-	using arc_bimap_rel = preprocess_info::arc_bimap::value_type;
-
-	int a2 = info.A2.size();
-	
+void add_toll_free_arc(preprocess_info& info, int src, int dst, cost_type cost,
+					   std::default_random_engine& rng, bool perturb) {
 	// Perturb the cost
 	constexpr static double TOLLFREE_PERTURBATION = 0.01;
-	static std::uniform_real_distribution<cost_type> dist;
-	static std::default_random_engine rng;
+	std::uniform_real_distribution<cost_type> dist;
 
-	cost += dist(rng) * TOLLFREE_PERTURBATION;
+	if (perturb)
+		cost += dist(rng) * TOLLFREE_PERTURBATION;
 
 	// If there exists a tolled arc with the same (src, dst), create a virtual node
-	if (info.bimap_A.right.count(make_pair(src, dst))) {
+	if (info.has_arc(src, dst)) {
 		int virt = info.V.size();
 		info.V.insert(virt);
 
-		info.A.insert(a);
-		info.A2.insert(a2);
-
-		info.bimap_A.insert(arc_bimap_rel(a, make_pair(virt, dst)));
-		info.bimap_A2.insert(arc_bimap_rel(a2, make_pair(virt, dst)));
-
-		info.cost_A.emplace(a, 0);
-		info.cost_A2.emplace(a2, 0);
-
-		info.is_tolled.emplace(a, false);
-
-		a++;
-		a2++;
+		info.add_arc(virt, dst, 0);
 		dst = virt;
 	}
 
-	info.A.insert(a);
-	info.A2.insert(a2);
-
-	info.bimap_A.insert(arc_bimap_rel(a, make_pair(src, dst)));
-	info.bimap_A2.insert(arc_bimap_rel(a2, make_pair(src, dst)));
-
-	info.cost_A.emplace(a, cost);
-	info.cost_A2.emplace(a2, cost);
-
-	info.is_tolled.emplace(a, false);
-
-	a++;
+	info.add_arc(src, dst, cost);
 }
 
 preprocess_info spgm_preprocessor::preprocess_impl(const light_graph& graph, const commodity& comm, int k)
 {
-	using arc_bimap_rel = preprocess_info::arc_bimap::value_type;
-
-	light_graph original = preprocessor::preprocess_impl(graph, comm, k).build_graph();
+	// Prices are shared between commodities on the problem graph, computed on a copy otherwise
+	const bool shared = oracle && &graph == &oracle->graph;
+	light_graph original = shared ? light_graph(0) : preprocessor::preprocess_impl(graph, comm, k).build_graph();
+
+	auto price_from_src = [&](int src, bool tolls_enabled) {
+		if (shared)
+			return oracle->price_from_src(src, tolls_enabled);
+		original.set_toll_arcs_enabled(tolls_enabled);
+		return original.price_from_src(src);
+	};
+	auto price_to_dst = [&](int dst, bool tolls_enabled) {
+		if (shared)
+			return oracle->price_to_dst(dst, tolls_enabled);
+		original.set_toll_arcs_enabled(tolls_enabled);
+		return original.price_to_dst(dst);
+	};
+
+	// Perturbation is seeded per commodity, so concurrent preprocessing stays reproducible
+	std::default_random_engine rng(k);
 
 	// Origin and destination prices
 	int orig = comm.origin;
 	int dest = comm.destination;
-	original.set_toll_arcs_enabled(true);
-	vector<cost_type> lower_orig = original.price_from_src(orig);
-	vector<cost_type> lower_dest = original.price_to_dst(dest);
+	vector<cost_type> lower_orig = price_from_src(orig, true);
+	vector<cost_type> lower_dest = price_to_dst(dest, true);
 
-	original.set_toll_arcs_enabled(false);
-	vector<cost_type> upper_orig = original.price_from_src(orig);
-	vector<cost_type> upper_dest = original.price_to_dst(dest);
+	vector<cost_type> upper_orig = price_from_src(orig, false);
+	vector<cost_type> upper_dest = price_to_dst(dest, false);
 
 	cost_type lower_total = lower_orig[dest];
 	cost_type upper_total = upper_orig[dest];
@@ -86,8 +75,7 @@ preprocess_info spgm_preprocessor::preprocess_impl(const light_graph& graph, con
 	LOOP(i, graph.V) info.V.insert(i);
 
 	// Add all tolled arcs
-	int a = 0;
-	for (const light_edge& e : original.Eall) {
+	for (const light_edge& e : graph.Eall) {
 		if (!e.is_tolled) continue;
 
 		cost_type cost = e.cost;
@@ -104,21 +92,10 @@ preprocess_info spgm_preprocessor::preprocess_impl(const light_graph& graph, con
 		if (upper_orig[j] <= lower_orig[i] + cost) continue;
 
 		// Pass, add to info
-		info.A.insert(a);
-		info.A1.insert(e.index);
-
-		info.bimap_A.insert(arc_bimap_rel(a, make_pair(i, j)));
-		info.bimap_A1.insert(arc_bimap_rel(e.index, make_pair(i, j)));
-
-		info.cost_A.emplace(a, cost);
-		info.cost_A1.emplace(e.index, cost);
-
-		info.is_tolled.emplace(a, true);
+		info.add_arc(i, j, cost, e.index);
 
 		all_src[i].insert(j);
 		all_dst[j].insert(i);
-
-		a++;
 	}
 
 	// Exclude O, D from set of src, dst
@@ -129,7 +106,7 @@ preprocess_info spgm_preprocessor::preprocess_impl(const light_graph& graph, con
 
 	// Add toll-free arcs
 	// O-D arc
-	add_toll_free_arc(info, a, orig, dest, upper_total);
+	add_toll_free_arc(info, orig, dest, upper_total, rng, perturb);
 
 	// O-src arcs
 	for (auto& pair : all_src) {
@@ -140,7 +117,7 @@ preprocess_info spgm_preprocessor::preprocess_impl(const light_graph& graph, con
 		// Rule #7
 		if (upper_total <= cost + lower_dest[i]) continue;
 
-		add_toll_free_arc(info, a, orig, i, cost);
+		add_toll_free_arc(info, orig, i, cost, rng, perturb);
 	}
 
 	// dst-D arcs
@@ -152,13 +129,13 @@ preprocess_info spgm_preprocessor::preprocess_impl(const light_graph& graph, con
 		// Rule #8
 		if (upper_total <= lower_orig[j] + cost) continue;
 
-		add_toll_free_arc(info, a, j, dest, cost);
+		add_toll_free_arc(info, j, dest, cost, rng, perturb);
 	}
 
 	// dst-src arcs
 	for (auto& pair_j : all_dst) {
 		int j = pair_j.first;
-		vector<cost_type> upper_j = original.price_from_src(j);
+		vector<cost_type> upper_j = price_from_src(j, false);
 
 		for (auto& pair_i : all_src) {
 			int i = pair_i.first;
@@ -181,11 +158,11 @@ preprocess_info spgm_preprocessor::preprocess_impl(const light_graph& graph, con
 				// i connects to j by a tolled arc
 				// only connect j to i if j has another i' and i has another j'
 				if (pair_j.second.size() > 1 && pair_i.second.size() > 1)
-					add_toll_free_arc(info, a, j, i, cost);
+					add_toll_free_arc(info, j, i, cost, rng, perturb);
 			}
 			else {
 				// i does not connect to j
-				add_toll_free_arc(info, a, j, i, cost);
+				add_toll_free_arc(info, j, i, cost, rng, perturb);
 			}
 		}
 	}
@@ -193,7 +170,7 @@ preprocess_info spgm_preprocessor::preprocess_impl(const light_graph& graph, con
 	info.prune(orig, dest);
 	info.clean();
 
-	cout << "Comm " << k << " (SPGM): " << info.V.size() << " nodes, "
+	*log << "Comm " << k << " (SPGM): " << info.V.size() << " nodes, "
 		<< info.A.size() << " arcs (" << info.A1.size() << " tolled)" << endl;
 
 	return info;
@@ -3,6 +3,10 @@
 #include "../base/preprocessor.h"
 
 struct spgm_preprocessor : public virtual preprocessor {
+	// Perturb the toll-free arcs to break ties between paths (off when exact distances are needed)
+	bool perturb;
+
+	spgm_preprocessor() : perturb(true) {}
 
 	virtual preprocess_info preprocess_impl(const light_graph& graph, const commodity& comm, int k = -1) override;
 };
\ No newline at end of file
@@ -1,24 +1,25 @@
 #pragma once
 
 #define LOOP(i, size) for (int i = 0; i < size; ++i)
-#define A1_TO_A(prob, a) (prob).alledges_index_map.right.at((prob).tolled_index_map.left.at(a))
-#define A2_TO_A(prob, a) (prob).alledges_index_map.right.at((prob).tollfree_index_map.left.at(a))
-#define A_TO_A1(prob, a) (prob).tolled_index_map.right.at((prob).alledges_index_map.left.at(a))
-#define A_TO_A2(prob, a) (prob).tollfree_index_map.right.at((prob).alledges_index_map.left.at(a))
+#define A1_TO_A(prob, a) (prob).a1_to_a[a]
+#define A2_TO_A(prob, a) (prob).a2_to_a[a]
+#define A_TO_A1(prob, a) (prob).a_to_a1_at(a)
+#define A_TO_A2(prob, a) (prob).a_to_a2_at(a)
 
-#define A_TO_EDGE(prob, a) (prob).alledges_index_map.left.at(a)
-#define A1_TO_EDGE(prob, a) (prob).tolled_index_map.left.at(a)
-#define A2_TO_EDGE(prob, a) (prob).tollfree_index_map.left.at(a)
+#define A_TO_EDGE(prob, a) (prob).a_to_edge[a]
+#define A1_TO_EDGE(prob, a) (prob).a_to_edge[(prob).a1_to_a[a]]
+#define A2_TO_EDGE(prob, a) (prob).a_to_edge[(prob).a2_to_a[a]]
 
-#define EDGE_FROM_SRC_DST(prob, src, dst) boost::edge(src, dst, (prob).graph).first
-#define EDGE_TO_A(prob, e) (prob).alledges_index_map.right.at(e)
-#define EDGE_TO_A1(prob, e) (prob).tolled_index_map.right.at(e)
-#define EDGE_TO_A2(prob, e) (prob).tollfree_index_map.right.at(e)
+#define SRC_DST_TO_A(prob, src, dst) (prob).src_dst_to_a(src, dst)
+#define EDGE_FROM_SRC_DST(prob, src, dst) (prob).a_to_edge.at((prob).src_dst_to_a(src, dst))
+#define EDGE_TO_A(prob, e) (prob).edge_to_a(e)
+#define EDGE_TO_A1(prob, e) (prob).a_to_a1_at((prob).edge_to_a(e))
+#define EDGE_TO_A2(prob, e) (prob).a_to_a2_at((prob).edge_to_a(e))
 
 #define SRC_DST(prob, edge) int src = source((edge), (prob).graph); int dst = target((edge), (prob).graph);
-#define SRC_DST_FROM_A(prob, a) auto edge = A_TO_EDGE(prob, a); SRC_DST(prob, edge)
-#define SRC_DST_FROM_A1(prob, a) auto edge = A1_TO_EDGE(prob, a); SRC_DST(prob, edge)
-#define SRC_DST_FROM_A2(prob, a) auto edge = A2_TO_EDGE(prob, a); SRC_DST(prob, edge)
+#define SRC_DST_FROM_A(prob, a) [[maybe_unused]] auto edge = A_TO_EDGE(prob, a); int src = (prob).arc_src[a]; int dst = (prob).arc_dst[a];
+#define SRC_DST_FROM_A1(prob, a) SRC_DST_FROM_A(prob, (prob).a1_to_a[a])
+#define SRC_DST_FROM_A2(prob, a) SRC_DST_FROM_A(prob, (prob).a2_to_a[a])
 
 // Problem multi
 #define A1_EXISTS(prob, k, a) ((prob).tolled_index_maps[k].left.find(a) != (prob).tolled_index_maps[k].left.end())
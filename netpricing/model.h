@@ -9,6 +9,7 @@
 #include <ilcplex/ilocplex.h>
 #include <vector>
 #include <sstream>
+#include <string>
 
 struct model_config {
 	int num_thread;
@@ -20,6 +21,13 @@ struct model_config {
 	int max_paths;
 	bool relax_only;
 	bool pre_spgm;
+	int follower_threads;
+	int strong_threads;
+	int enum_time_limit;
+	int enum_memory_limit;
+	std::string path_cache_dir;
+	int bb_memory_limit;
+	std::string bb_spill_dir;
 };
 
 struct model_base {
@@ -67,15 +75,17 @@ struct model_base {
 struct model_single {
 	using problem_type = problem;
 
-	problem prob;
+	// Shared with every solver built on prob
+	std::shared_ptr<const problem> prob_ptr;
+	const problem& prob;
 	int K, V, A, A1, A2;
 
-	model_single(const problem& _prob) : prob(_prob) {
+	model_single(const problem& _prob) : prob_ptr(problem::share(_prob)), prob(*prob_ptr) {
 		K = prob.commodities.size();
 		V = boost::num_vertices(prob.graph);
 		A = boost::num_edges(prob.graph);
-		A1 = prob.tolled_index_map.size();
-		A2 = prob.tollfree_index_map.size();
+		A1 = prob.a1_to_a.size();
+		A2 = prob.a2_to_a.size();
 	}
 };
 
@@ -51,7 +51,7 @@ compslack_model::compslack_model(IloEnv& env, const problem& _prob) : model_cple
 	// Objective
 	obj = IloMaximize(env);
 	LOOP(k, K) {
-		commodity& comm = prob.commodities[k];
+		const commodity& comm = prob.commodities[k];
 		demand_type demand = comm.demand;
 
 		obj.setLinearCoef(lambda[k][comm.origin], demand);
@@ -66,7 +66,7 @@ standard_model::standard_model(IloEnv& env, const problem& _prob) : model_cplex(
 
 	// Flow matrix
 	LOOP(a, A) {
-		auto edge = prob.alledges_index_map.left.at(a);
+		auto edge = A_TO_EDGE(prob, a);
 		int src = source(edge, prob.graph);
 		int dst = target(edge, prob.graph);
 
@@ -78,7 +78,7 @@ standard_model::standard_model(IloEnv& env, const problem& _prob) : model_cplex(
 	dual_feas = RangeMatrix(env, K);
 	LOOP(k, K) dual_feas[k] = RangeArray(env, A);
 	LOOP(a, A) {
-		auto edge = prob.alledges_index_map.left.at(a);
+		auto edge = A_TO_EDGE(prob, a);
 		int src = source(edge, prob.graph);
 		int dst = target(edge, prob.graph);
 		bool is_tolled = prob.is_tolled_map[edge];
@@ -94,7 +94,7 @@ standard_model::standard_model(IloEnv& env, const problem& _prob) : model_cplex(
 	// Equal objective
 	equal_obj = RangeArray(env, K, 0, 0);
 	LOOP(a, A) {
-		auto edge = prob.alledges_index_map.left.at(a);
+		auto edge = A_TO_EDGE(prob, a);
 		cost_type cost = prob.cost_map[edge];
 		LOOP(k, K) equal_obj[k].setLinearCoef(z[k][a], cost);
 	}
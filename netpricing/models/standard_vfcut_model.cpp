@@ -143,7 +143,7 @@ standard_vfcut_model::standard_vfcut_model(IloEnv& env, const problem& _prob) :
 
 	// Flow matrix
 	LOOP(a, A) {
-		auto edge = prob.alledges_index_map.left.at(a);
+		auto edge = A_TO_EDGE(prob, a);
 		int src = source(edge, prob.graph);
 		int dst = target(edge, prob.graph);
 
@@ -155,7 +155,7 @@ standard_vfcut_model::standard_vfcut_model(IloEnv& env, const problem& _prob) :
 	dual_feas = RangeMatrix(env, K);
 	LOOP(k, K) dual_feas[k] = RangeArray(env, A);
 	LOOP(a, A) {
-		auto edge = prob.alledges_index_map.left.at(a);
+		auto edge = A_TO_EDGE(prob, a);
 		int src = source(edge, prob.graph);
 		int dst = target(edge, prob.graph);
 		bool is_tolled = prob.is_tolled_map[edge];
@@ -171,7 +171,7 @@ standard_vfcut_model::standard_vfcut_model(IloEnv& env, const problem& _prob) :
 	// Equal objective
 	equal_obj = RangeArray(env, K, 0, 0);
 	LOOP(a, A) {
-		auto edge = prob.alledges_index_map.left.at(a);
+		auto edge = A_TO_EDGE(prob, a);
 		cost_type cost = prob.cost_map[edge];
 		LOOP(k, K) equal_obj[k].setLinearCoef(z[k][a], cost);
 	}
@@ -277,4 +277,5 @@ void value_func_model::config(const model_config& conf)
 	if (conf.heur_freq >= 0)
 		heur_freq = conf.heur_freq;
 	pre_cut = conf.pre_cut;
+	builder.solver.set_num_threads(conf.follower_threads);
 }
@@ -9,6 +9,7 @@
 #include <fstream>
 #include <sstream>
 #include <thread>
+#include <memory>
 #include <regex>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 #include <boost/program_options.hpp>
@@ -138,6 +139,14 @@ int main(int argc, char* argv[])
 		("max-paths,P", po::value<int>()->default_value(10), "maximum num paths for path hybrid models")
 		("relax-only,R", "only solve the relaxation")
 		("pre-spgm,S", "apply SPGM before path-based preprocessing")
+		("spgm-big-m", "tighten the big M values with the SPGM of each commodity")
+		("follower-thread", po::value<int>()->default_value(1), "number of threads of the follower solvers")
+		("strong-thread", po::value<int>()->default_value(1), "number of strong branching evaluations run concurrently per branch and bound worker")
+		("enum-time", po::value<int>()->default_value(0), "path enumeration time budget per commodity in ms (0 = no limit)")
+		("enum-memory", po::value<int>()->default_value(0), "path enumeration memory budget per commodity in MB (0 = no limit)")
+		("path-cache", po::value<string>()->default_value(""), "directory of the enumerated path cache (empty = disabled)")
+		("bb-memory", po::value<int>()->default_value(0), "open node memory budget of the branch and bound in MB, nodes beyond are spilled to disk (0 = no limit)")
+		("bb-spill-dir", po::value<string>()->default_value(""), "directory of the branch and bound spill files (empty = temporary directory)")
 
 		("nodes,n", po::value<int>()->default_value(10), "number of nodes in the random problem")
 		("arcs,a", po::value<int>()->default_value(20), "number of arcs in the random problem")
@@ -184,17 +193,17 @@ int main(int argc, char* argv[])
 	auto random_engine = default_random_engine(seed);
 
 	// Create a problem
-	problem* prob;
+	std::shared_ptr<problem> prob;
 	problem_multi* prob_multi;
 	if (vm.count("input")) {
-		prob = new problem(problem::read_from_json(vm["input"].as<string>())[0]);
+		prob = std::make_shared<problem>(problem::read_from_json(vm["input"].as<string>())[0]);
 		cout << "NETWORK imported from " << vm["input"].as<string>() << endl;
 	}
 	else if (vm.count("grid")) {
 		auto params = vm["grid"].as<grid_params>();
 		int k = vm["commodities"].as<int>();
 		float p = vm["toll-proportion"].as<float>();
-		prob = new problem(random_grid_problem(params.width, params.height, k, p, random_engine));
+		prob = std::make_shared<problem>(random_grid_problem(params.width, params.height, k, p, random_engine));
 		int n = num_vertices(prob->graph);
 		int a = num_edges(prob->graph);
 
@@ -210,7 +219,7 @@ int main(int argc, char* argv[])
 		int n = vm["delaunay"].as<int>();
 		int k = vm["commodities"].as<int>();
 		float p = vm["toll-proportion"].as<float>();
-		prob = new problem(random_delaunay_problem(n, k, p, random_engine));
+		prob = std::make_shared<problem>(random_delaunay_problem(n, k, p, random_engine));
 		int a = num_edges(prob->graph);
 
 		cout << "DELAUNAY NETWORK created:" << endl;
@@ -223,7 +232,7 @@ int main(int argc, char* argv[])
 		int n = vm["voronoi"].as<int>();
 		int k = vm["commodities"].as<int>();
 		float p = vm["toll-proportion"].as<float>();
-		prob = new problem(random_voronoi_problem(n, k, p, random_engine));
+		prob = std::make_shared<problem>(random_voronoi_problem(n, k, p, random_engine));
 		n = num_vertices(prob->graph);
 		int a = num_edges(prob->graph);
 
@@ -238,7 +247,7 @@ int main(int argc, char* argv[])
 		int a = vm["arcs"].as<int>();
 		int k = vm["commodities"].as<int>();
 		float p = vm["toll-proportion"].as<float>();
-		prob = new problem(random_problem(n, a, k, p, random_engine));
+		prob = std::make_shared<problem>(random_problem(n, a, k, p, random_engine));
 
 		cout << "RANDOM NETWORK created:" << endl;
 		cout << "    n = " << n << endl;
@@ -248,10 +257,15 @@ int main(int argc, char* argv[])
 	}
 	report_obj["problem"] = prob->get_json();
 
+	if (vm.count("spgm-big-m")) {
+		prob->update_big_mn(true, vm["thread"].as<int>());
+		cout << "BIG M tightened with the SPGM" << endl;
+	}
+
 	// Problem multi
 	bool is_multi = vm.count("multi") > 0;
 	if (is_multi) {
-		prob_multi = new problem_multi(*static_cast<problem*>(prob));
+		prob_multi = new problem_multi(*prob);
 		cout << "MULTI-GRAPH version activated" << endl;
 	}
 
@@ -270,6 +284,13 @@ int main(int argc, char* argv[])
 	const int max_paths = vm["max-paths"].as<int>();
 	const bool relax_only = vm.count("relax-only");
 	const bool pre_spgm = vm.count("pre-spgm");
+	const int follower_threads = vm["follower-thread"].as<int>();
+	const int strong_threads = vm["strong-thread"].as<int>();
+	const int enum_time_limit = vm["enum-time"].as<int>();
+	const int enum_memory_limit = vm["enum-memory"].as<int>();
+	const string path_cache_dir = vm["path-cache"].as<string>();
+	const int bb_memory_limit = vm["bb-memory"].as<int>();
+	const string bb_spill_dir = vm["bb-spill-dir"].as<string>();
 
 	// Configuration
 	config conf = {
@@ -283,7 +304,14 @@ int main(int argc, char* argv[])
 			.full_mode = full_mode,
 			.max_paths = max_paths,
 			.relax_only = relax_only,
-			.pre_spgm = pre_spgm
+			.pre_spgm = pre_spgm,
+			.follower_threads = follower_threads,
+			.strong_threads = strong_threads,
+			.enum_time_limit = enum_time_limit,
+			.enum_memory_limit = enum_memory_limit,
+			.path_cache_dir = path_cache_dir,
+			.bb_memory_limit = bb_memory_limit,
+			.bb_spill_dir = bb_spill_dir
 		}
 	};
 	cout << boolalpha << "Config:" << endl <<
@@ -295,7 +323,12 @@ int main(int argc, char* argv[])
 		"  Full mode: " << full_mode << endl <<
 		"  Max num paths: " << max_paths << endl <<
 		"  Relax only: " << relax_only << endl <<
-		"  Pre SPGM: " << pre_spgm << endl;
+		"  Pre SPGM: " << pre_spgm << endl <<
+		"  Follower threads: " << follower_threads << endl <<
+		"  Strong branching threads: " << strong_threads << endl <<
+		"  Enumeration budget: " << enum_time_limit << " ms, " << enum_memory_limit << " MB" << endl <<
+		"  Path cache: " << (path_cache_dir.empty() ? "disabled" : path_cache_dir) << endl <<
+		"  B&B memory budget: " << bb_memory_limit << " MB" << endl;
 
 	if (vm.count("standard")) {
 		report << "STANDARD:" << endl;
@@ -458,7 +491,6 @@ int main(int argc, char* argv[])
 
 	// Clean up
 	env.end();
-	delete prob;
 
 	return 0;
 }
@@ -469,6 +501,10 @@ bool assert_args(const vector<string>& args, int min_length) {
 	return args.size() >= min_length;
 }
 
+string optional_arg(const vector<string>& args, int index) {
+	return (int)args.size() > index ? args[index] : "";
+}
+
 void run_routine(int index, const vector<string>& args)
 {
 	switch (index)
@@ -498,11 +534,18 @@ void run_routine(int index, const vector<string>& args)
 	case 22: light_graph_bilevel_feasible_2_perftest(); break;
 	case 23: light_graph_bilevel_feasible_3_acctest(); break;
 	case 24: light_graph_bilevel_feasible_3_perftest(); break;
-	case 25: if (assert_args(args, 2)) data_numpaths_stats(args[0], atoi(args[1].c_str())); break;
-	case 26: if (assert_args(args, 2)) data_pathenum_stats(args[0], atoi(args[1].c_str())); break;
-	case 27: if (assert_args(args, 2)) data_preprocessing_stats(args[0], atoi(args[1].c_str())); break;
+	case 25: if (assert_args(args, 2)) data_numpaths_stats(args[0], atoi(args[1].c_str()), optional_arg(args, 2)); break;
+	case 26: if (assert_args(args, 2)) data_pathenum_stats(args[0], atoi(args[1].c_str()), optional_arg(args, 2)); break;
+	case 27: if (assert_args(args, 2)) data_preprocessing_stats(args[0], atoi(args[1].c_str()), optional_arg(args, 2)); break;
 	case 28: if (assert_args(args, 1)) data_dimensions_stats(args[0]); break;
-	case 29: if (assert_args(args, 2)) data_path_spgm_preprocessing_stats(args[0], atoi(args[1].c_str())); break;
+	case 29: if (assert_args(args, 2)) data_path_spgm_preprocessing_stats(args[0], atoi(args[1].c_str()), optional_arg(args, 2)); break;
+	case 30: follower_light_solver_radix_acctest(); break;
+	case 31: light_graph_point_to_point_perftest(); break;
+	case 32: follower_cch_solver_perftest(); break;
+	case 33: follower_light_solver_thread_perftest(); break;
+	case 34: follower_solver_batch_perftest(); break;
+	case 35: follower_skeleton_solver_perftest(); break;
+	case 36: if (assert_args(args, 2)) data_preprocessing_perftest(args[0], atoi(args[1].c_str()), optional_arg(args, 2)); break;
 	default:
 		cerr << "Wrong routine number" << endl;
 		break;
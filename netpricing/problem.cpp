@@ -10,12 +10,9 @@
 
 #include <boost/graph/copy.hpp>
 #include <boost/graph/graph_traits.hpp>
-#include <boost/graph/dijkstra_shortest_paths.hpp>
 
 #include "macros.h"
-
-#define GET_DISTANCE_MAP(graph, source, map) \
-	boost::dijkstra_shortest_paths(graph, source, boost::distance_map(boost::make_iterator_property_map(map.begin(), boost::get(boost::vertex_index, graph))))
+#include "utilities/big_mn_engine.h"
 
 using namespace std;
 using namespace boost;
@@ -39,15 +36,29 @@ problem::problem(const graph_type& _graph, std::vector<commodity>&& commodities)
 	update();
 }
 
-problem::problem(const problem& prob) : problem(prob.graph, prob.commodities) { }
+// Big M and N only depend on the copied data, the edge descriptors must be rebuilt
+problem::problem(const problem& prob) :
+	std::enable_shared_from_this<problem>(),
+	graph(prob.graph), commodities(prob.commodities),
+	is_tolled_map(boost::get(edge_tolled, graph)),
+	cost_map(boost::get(boost::edge_weight, graph)),
+	tollfree_graph(graph, edge_tollfree_predicate<edge_tolled_map_type>(is_tolled_map)),
+	big_m(prob.big_m),
+	big_n(prob.big_n),
+	obj_upper_bound(prob.obj_upper_bound)
+{
+	update_indices();
+}
 
 problem::problem(problem&& prob) :
+	std::enable_shared_from_this<problem>(),
 	graph(prob.graph), commodities(std::move(prob.commodities)),
 	is_tolled_map(boost::get(edge_tolled, graph)),
 	cost_map(boost::get(boost::edge_weight, graph)),
 	tollfree_graph(graph, edge_tollfree_predicate<edge_tolled_map_type>(is_tolled_map)),
 	big_m(std::move(prob.big_m)),
-	big_n(std::move(prob.big_n))
+	big_n(std::move(prob.big_n)),
+	obj_upper_bound(prob.obj_upper_bound)
 {
 	update_indices();
 }
@@ -197,101 +208,105 @@ void problem::update()
 	update_big_mn();
 }
 
+std::shared_ptr<const problem> problem::share(const problem& prob)
+{
+	auto snapshot = prob.weak_from_this().lock();
+	return snapshot ? snapshot : std::make_shared<const problem>(prob);
+}
+
 void problem::update_indices()
 {
 	using namespace std;
 	using namespace boost;
-	using edge_index_rel = edge_index_bimap_type::value_type;
 
-	// Reset
-	tolled_index_map.clear();
-	tollfree_index_map.clear();
-	alledges_index_map.clear();
+	int V = num_vertices(graph);
+	int A = num_edges(graph);
 
-	// Mapping
+	// Split the edges, tolled first
+	vector<edge_descriptor> tolled, tollfree;
 	edge_iterator ei, ei_end;
-	int tolled_index = 0, tollfree_index = 0;
-
 	for (tie(ei, ei_end) = edges(graph); ei != ei_end; ++ei) {
-		bool is_tolled = is_tolled_map[*ei];
-		if (is_tolled) {
-			tolled_index_map.insert(edge_index_rel(tolled_index++, *ei));
-		}
-		else {
-			tollfree_index_map.insert(edge_index_rel(tollfree_index++, *ei));
-		}
+		if (is_tolled_map[*ei])
+			tolled.push_back(*ei);
+		else
+			tollfree.push_back(*ei);
 	}
 
-	// All edges mapping
-	auto alledges_inserter = inserter(alledges_index_map, alledges_index_map.begin());
+	int A1 = tolled.size();
+	int A2 = tollfree.size();
 
-	copy(tolled_index_map.begin(), tolled_index_map.end(), alledges_inserter);
-	transform(tollfree_index_map.begin(), tollfree_index_map.end(), alledges_inserter,
-			  [tolled_index](const edge_index_rel& entry) {
-				  return edge_index_rel(entry.left + tolled_index, entry.right);
-			  });
-}
+	a_to_edge = std::move(tolled);
+	a_to_edge.insert(a_to_edge.end(), tollfree.begin(), tollfree.end());
 
-void problem::update_big_mn()
-{
-	int V = num_vertices(graph);
-	int K = commodities.size();
-	int A1 = tolled_index_map.size();
+	a1_to_a.resize(A1);
+	a2_to_a.resize(A2);
+	a_to_a1.assign(A, -1);
+	a_to_a2.assign(A, -1);
+	arc_src.resize(A);
+	arc_dst.resize(A);
 
-	big_m = cost_matrix(K, cost_array(A1));
-	big_n = cost_array(A1);
-
-	cost_matrix tollfree_o(K, cost_array(V)), nulltoll_o(K, cost_array(V));
-	LOOP(k, K) {
-		int o = commodities[k].origin;
-		GET_DISTANCE_MAP(graph, o, nulltoll_o[k]);
-		GET_DISTANCE_MAP(tollfree_graph, o, tollfree_o[k]);
+	LOOP(a1, A1) {
+		a1_to_a[a1] = a1;
+		a_to_a1[a1] = a1;
+	}
+	LOOP(a2, A2) {
+		a2_to_a[a2] = A1 + a2;
+		a_to_a2[A1 + a2] = a2;
+	}
+	LOOP(a, A) {
+		arc_src[a] = source(a_to_edge[a], graph);
+		arc_dst[a] = target(a_to_edge[a], graph);
 	}
 
-	LOOP(a, A1) {
-		auto edge = tolled_index_map.left.at(a);
-		int i = source(edge, graph);
-		int j = target(edge, graph);
-		cost_type c = cost_map[edge];
-
-		cost_array tollfree_i(V), nulltoll_j(V);
-		GET_DISTANCE_MAP(graph, j, nulltoll_j);
-		GET_DISTANCE_MAP(tollfree_graph, i, tollfree_i);
-
-		big_n[a] = -numeric_limits<cost_type>::infinity();
-		LOOP(k, K) {
-			int o = commodities[k].origin;
-			int d = commodities[k].destination;
-
-			cost_type m1, m2, m3, m4;
-			m1 = tollfree_i[j] - c;
-			m2 = tollfree_o[k][j] - nulltoll_o[k][i] - c;
-			m3 = tollfree_i[d] - c - nulltoll_j[d];
-			m4 = tollfree_o[k][d] - nulltoll_o[k][i] - c - nulltoll_j[d];
-
-			// M has 0.001f tolerance because exact M may cause infeasibility of subproblem
-			big_m[k][a] = max((cost_type)0, min({ m1, m2, m3, m4 }));
-			big_n[a] = max(big_n[a], big_m[k][a]);
-		}
+	// CSR by source, then sorted by destination (stable for parallel arcs)
+	out_begin.assign(V + 1, 0);
+	LOOP(a, A) out_begin[arc_src[a] + 1]++;
+	LOOP(i, V) out_begin[i + 1] += out_begin[i];
+
+	out_a.resize(A);
+	vector<int> pos(out_begin.begin(), out_begin.end() - 1);
+	LOOP(a, A) out_a[pos[arc_src[a]]++] = a;
+
+	LOOP(i, V) {
+		stable_sort(out_a.begin() + out_begin[i], out_a.begin() + out_begin[i + 1],
+					[this](int a, int b) { return arc_dst[a] < arc_dst[b]; });
 	}
+
+	out_dst.resize(A);
+	LOOP(j, A) out_dst[j] = arc_dst[out_a[j]];
 }
 
-cost_type problem::get_obj_upper_bound() const
+int problem::src_dst_to_a(int src, int dst) const
 {
-	int V = num_vertices(graph);
-	int K = commodities.size();
-
-	cost_type sum_obj = 0;
-	LOOP(k, K) {
-		int o = commodities[k].origin;
-		int d = commodities[k].destination;
+	auto first = out_dst.begin() + out_begin[src];
+	auto last = out_dst.begin() + out_begin[src + 1];
+	auto it = lower_bound(first, last, dst);
+	return (it != last && *it == dst) ? out_a[it - out_dst.begin()] : -1;
+}
 
-		cost_array tollfree(V), nulltoll(V);
-		GET_DISTANCE_MAP(graph, o, nulltoll);
-		GET_DISTANCE_MAP(tollfree_graph, o, tollfree);
+int problem::edge_to_a(const edge_descriptor& edge) const
+{
+	int src = boost::source(edge, graph);
+	int dst = boost::target(edge, graph);
 
-		sum_obj += (tollfree[d] - nulltoll[d]) * commodities[k].demand;
+	// Parallel arcs share (src, dst), tell them apart by descriptor
+	for (int j = out_begin[src]; j < out_begin[src + 1]; j++) {
+		if (out_dst[j] == dst && a_to_edge[out_a[j]] == edge)
+			return out_a[j];
 	}
+	throw out_of_range("edge is not in the problem graph");
+}
 
-	return sum_obj;
-}
\ No newline at end of file
+void problem::update_big_mn(bool spgm_bounds, int num_threads)
+{
+	auto res = big_mn_engine(num_threads, spgm_bounds).compute(*this);
+
+	big_m = std::move(res.big_m);
+	big_n = std::move(res.big_n);
+	obj_upper_bound = res.obj_upper_bound;
+}
+
+cost_type problem::get_obj_upper_bound() const
+{
+	return obj_upper_bound;
+}
@@ -2,7 +2,11 @@
 
 #include "problem_base.h"
 
-struct problem : public problem_base
+#include <memory>
+#include <stdexcept>
+
+// Models and utilities share one immutable snapshot through problem::share
+struct problem : public problem_base, public std::enable_shared_from_this<problem>
 {
 	// Main data
 	graph_type graph;
@@ -12,13 +16,19 @@ struct problem : public problem_base
 	edge_tolled_map_type is_tolled_map;
 	edge_cost_map_type cost_map;
 
-	edge_index_bimap_type tolled_index_map;
-	edge_index_bimap_type tollfree_index_map;
-	edge_index_bimap_type alledges_index_map;
+	// Index translation (tolled arcs first, -1 when the arc is not of that kind)
+	std::vector<int> a1_to_a, a2_to_a;
+	std::vector<int> a_to_a1, a_to_a2;
+	std::vector<int> arc_src, arc_dst;
+	std::vector<edge_descriptor> a_to_edge;
+
+	// (src, dst) to arc index, outgoing arcs of each node sorted by dst
+	std::vector<int> out_begin, out_dst, out_a;
 
 	tollfree_graph_type tollfree_graph;
 	big_m_type big_m;
 	big_n_type big_n;
+	cost_type obj_upper_bound;
 
 	// Constructor
 	problem(const graph_type& graph, const std::vector<commodity>& commodities);
@@ -37,11 +47,31 @@ struct problem : public problem_base
 	virtual nlohmann::json get_json() const override;
 	void write_to_json(std::string filename) const;
 
+	// Snapshot owning prob if it is already shared, a copy otherwise
+	static std::shared_ptr<const problem> share(const problem& prob);
+
 	// Update auxiliary data
 	void update();
 	void update_indices();
-	void update_big_mn();
+	void update_big_mn(bool spgm_bounds = false, int num_threads = 1);
 
 	// Utilities
 	cost_type get_obj_upper_bound() const;
+
+	int src_dst_to_a(int src, int dst) const;
+	int edge_to_a(const edge_descriptor& edge) const;
+
+	// Checked translations (throw for an arc of the other kind)
+	int a_to_a1_at(int a) const {
+		int a1 = a_to_a1.at(a);
+		if (a1 < 0)
+			throw std::out_of_range("arc is not tolled");
+		return a1;
+	}
+	int a_to_a2_at(int a) const {
+		int a2 = a_to_a2.at(a);
+		if (a2 < 0)
+			throw std::out_of_range("arc is tolled");
+		return a2;
+	}
 };
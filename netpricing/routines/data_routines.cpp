@@ -1,6 +1,8 @@
 #include <iostream>
 #include <string>
+#include <sstream>
 #include <regex>
+#include <chrono>
 #include <experimental/filesystem>
 
 #include "../macros.h"
@@ -8,11 +10,19 @@
 #include "../graph/light_graph.h"
 #include "../hybrid/preprocessors/path_preprocessor.h"
 #include "../hybrid/preprocessors/spgm_preprocessor.h"
+#include "../utilities/path_cache.h"
+#include "../utilities/distance_oracle.h"
 
 using namespace std;
 namespace fs = std::experimental::filesystem;
 
-void data_numpaths_stats(string prefix, int numpaths) {
+// On stderr, the statistics on stdout stay tabular
+static void print_distance_stats(const distance_oracle& oracle) {
+	cerr << "Distance cache: " << oracle.hits.load() << " hits, " << oracle.misses.load() << " misses (" <<
+		oracle.hit_rate() * 100 << "% hit rate)" << endl;
+}
+
+void data_numpaths_stats(string prefix, int numpaths, string cache_dir) {
 	regex fileregex("^" + prefix + "\\S*\\.json$");
 
 	for (auto& entry : fs::directory_iterator(".")) {
@@ -23,9 +33,15 @@ void data_numpaths_stats(string prefix, int numpaths) {
 		problem prob = problem::read_from_json(filename)[0];
 		light_graph lgraph(prob.graph);
 
+		path_cache cache;
+		if (!cache_dir.empty())
+			cache.open(cache_dir, prob);
+
 		LOOP(k, prob.commodities.size()) {
 			commodity& comm = prob.commodities[k];
-			auto ps = lgraph.bilevel_feasible_paths_2(comm.origin, comm.destination, numpaths + 1);
+			auto ps = cache.get("bfp2", k, false, numpaths + 1, [&](int n) {
+				return lgraph.bilevel_feasible_paths_2(comm.origin, comm.destination, n);
+			});
 			if (ps.size() <= numpaths)
 				cout << ps.size() << endl;
 			else
@@ -34,7 +50,7 @@ void data_numpaths_stats(string prefix, int numpaths) {
 	}
 }
 
-void data_pathenum_stats(string prefix, int numpaths) {
+void data_pathenum_stats(string prefix, int numpaths, string cache_dir) {
 	regex fileregex("^" + prefix + "\\S*\\.json$");
 
 	for (auto& entry : fs::directory_iterator(".")) {
@@ -45,9 +61,15 @@ void data_pathenum_stats(string prefix, int numpaths) {
 		problem prob = problem::read_from_json(filename)[0];
 		light_graph lgraph(prob.graph);
 
+		path_cache cache;
+		if (!cache_dir.empty())
+			cache.open(cache_dir, prob);
+
 		LOOP(k, prob.commodities.size()) {
 			commodity& comm = prob.commodities[k];
-			auto ps = lgraph.bilevel_feasible_paths_2(comm.origin, comm.destination, numpaths + 1, false);
+			auto ps = cache.get("bfp2nf", k, false, numpaths + 1, [&](int n) {
+				return lgraph.bilevel_feasible_paths_2(comm.origin, comm.destination, n, false);
+			});
 			auto rs = lgraph.filter_bilevel_feasible(ps);
 
 			cout << ps.size() << "\t" << rs.size() << endl;
@@ -55,7 +77,7 @@ void data_pathenum_stats(string prefix, int numpaths) {
 	}
 }
 
-void data_preprocessing_stats(string prefix, int numpaths) {
+void data_preprocessing_stats(string prefix, int numpaths, string cache_dir) {
 	regex fileregex("^" + prefix + "\\S*\\.json$");
 
 	for (auto& entry : fs::directory_iterator(".")) {
@@ -65,12 +87,19 @@ void data_preprocessing_stats(string prefix, int numpaths) {
 
 		problem prob = problem::read_from_json(filename)[0];
 		light_graph lgraph(prob.graph);
+		distance_oracle oracle(prob);
+
+		path_cache cache;
+		if (!cache_dir.empty())
+			cache.open(cache_dir, prob);
 
 		const char* TAB = "\t";
 
 		LOOP(k, prob.commodities.size()) {
 			commodity& comm = prob.commodities[k];
-			auto ps = lgraph.bilevel_feasible_paths_2(comm.origin, comm.destination, numpaths + 1);
+			auto ps = cache.get("bfp2", k, false, numpaths + 1, [&](int n) {
+				return lgraph.bilevel_feasible_paths_2(comm.origin, comm.destination, n);
+			});
 
 			cout << ps.size() << TAB;
 
@@ -88,6 +117,7 @@ void data_preprocessing_stats(string prefix, int numpaths) {
 			}
 
 			spgm_preprocessor sproc;
+			sproc.oracle = &oracle;
 
 			std::cout.setstate(std::ios_base::failbit);
 			auto info2 = sproc.preprocess(prob, k);
@@ -95,7 +125,100 @@ void data_preprocessing_stats(string prefix, int numpaths) {
 
 			cout << info2.V.size() << TAB << info2.A.size() << TAB << info2.A1.size() << endl;
 		}
+
+		print_distance_stats(oracle);
+	}
+}
+
+// Preprocessing times and preprocess_info lookup times, on the corpus of data_preprocessing_stats
+void data_preprocessing_perftest(string prefix, int numpaths, string cache_dir) {
+	regex fileregex("^" + prefix + "\\S*\\.json$");
+
+	const int REPEAT = 100;
+	const char* TAB = "\t";
+
+	double total_path_time = 0, total_spgm_time = 0, total_lookup_time = 0;
+	long long total_lookups = 0;
+	volatile long long checksum = 0;
+
+	// Access pattern of the formulations: iterate the arcs, convert the indices and look the arcs up by endpoints
+	auto lookups = [&](const preprocess_info& info, long long& count) {
+		LOOP(r, REPEAT) {
+			LOOP_INFO(a, A) {
+				const auto& arc = info.arc_A[a];
+				checksum += info.src_dst_to_a(arc.first, arc.second);
+				checksum += info.is_tolled[a] ? info.a_to_a1(a) : info.a_to_a2(a);
+				checksum += info.cost_A[a];
+			}
+			LOOP_INFO(a, A1) checksum += info.a1_to_a(a);
+			LOOP_INFO(a, A2) checksum += info.a2_to_a(a);
+			count += 3 * info.A.size();
+		}
+	};
+
+	cout << "file" << TAB << "path (ms)" << TAB << "spgm (ms)" << TAB << "lookup (ns)" << endl;
+
+	for (auto& entry : fs::directory_iterator(".")) {
+		string filename = string(entry.path().filename());
+		if (!regex_match(filename, fileregex))
+			continue;
+
+		problem prob = problem::read_from_json(filename)[0];
+		light_graph lgraph(prob.graph);
+		distance_oracle oracle(prob);
+
+		path_cache cache;
+		if (!cache_dir.empty())
+			cache.open(cache_dir, prob);
+
+		ostringstream null_log;
+		double path_time = 0, spgm_time = 0, lookup_time = 0;
+		long long num_lookups = 0;
+
+		LOOP(k, (int)prob.commodities.size()) {
+			commodity& comm = prob.commodities[k];
+			auto ps = cache.get("bfp2", k, false, numpaths + 1, [&](int n) {
+				return lgraph.bilevel_feasible_paths_2(comm.origin, comm.destination, n);
+			});
+
+			vector<preprocess_info> infos;
+
+			// Enumeration is excluded from the timings
+			auto start = chrono::high_resolution_clock::now();
+			if ((int)ps.size() <= numpaths) {
+				path_preprocessor pproc(ps);
+				pproc.log = &null_log;
+				pproc.oracle = &oracle;
+				infos.push_back(pproc.preprocess(prob, k));
+			}
+			auto path_done = chrono::high_resolution_clock::now();
+
+			spgm_preprocessor sproc;
+			sproc.log = &null_log;
+			sproc.oracle = &oracle;
+			infos.push_back(sproc.preprocess(prob, k));
+			auto spgm_done = chrono::high_resolution_clock::now();
+
+			for (const auto& info : infos)
+				lookups(info, num_lookups);
+			auto lookup_done = chrono::high_resolution_clock::now();
+
+			path_time += chrono::duration<double>(path_done - start).count();
+			spgm_time += chrono::duration<double>(spgm_done - path_done).count();
+			lookup_time += chrono::duration<double>(lookup_done - spgm_done).count();
+		}
+
+		cout << filename << TAB << path_time * 1000 << TAB << spgm_time * 1000 << TAB <<
+			lookup_time * 1e9 / max(num_lookups, 1LL) << endl;
+
+		total_path_time += path_time;
+		total_spgm_time += spgm_time;
+		total_lookup_time += lookup_time;
+		total_lookups += num_lookups;
 	}
+
+	cout << "total" << TAB << total_path_time * 1000 << TAB << total_spgm_time * 1000 << TAB <<
+		total_lookup_time * 1e9 / max(total_lookups, 1LL) << endl;
 }
 
 void data_dimensions_stats(string prefix) {
@@ -115,7 +238,7 @@ void data_dimensions_stats(string prefix) {
 }
 
 
-void data_path_spgm_preprocessing_stats(string prefix, int numpaths) {
+void data_path_spgm_preprocessing_stats(string prefix, int numpaths, string cache_dir) {
 	regex fileregex("^" + prefix + "\\S*\\.json$");
 
 	for (auto& entry : fs::directory_iterator(".")) {
@@ -124,12 +247,18 @@ void data_path_spgm_preprocessing_stats(string prefix, int numpaths) {
 			continue;
 
 		problem prob = problem::read_from_json(filename)[0];
+		distance_oracle oracle(prob);
+
+		path_cache cache;
+		if (!cache_dir.empty())
+			cache.open(cache_dir, prob);
 
 		const char* TAB = "\t";
 
 		LOOP(k, prob.commodities.size()) {
 			commodity& comm = prob.commodities[k];
 			spgm_preprocessor sproc;
+			sproc.oracle = &oracle;
 
 			std::cout.setstate(std::ios_base::failbit);
 			auto info = sproc.preprocess(prob, k);
@@ -137,7 +266,9 @@ void data_path_spgm_preprocessing_stats(string prefix, int numpaths) {
 
 			light_graph graph = info.build_graph();
 
-			auto ps = graph.bilevel_feasible_paths_2(comm.origin, comm.destination, numpaths + 1);
+			auto ps = cache.get("bfp2", k, true, numpaths + 1, [&](int n) {
+				return graph.bilevel_feasible_paths_2(comm.origin, comm.destination, n);
+			});
 
 			cout << ps.size() << TAB;
 
@@ -154,5 +285,7 @@ void data_path_spgm_preprocessing_stats(string prefix, int numpaths) {
 				cout << "-1" << TAB << "-1" << TAB << "-1" << endl;
 			}
 		}
+
+		print_distance_stats(oracle);
 	}
 }
\ No newline at end of file
@@ -1,13 +1,29 @@
 #include "../utilities/follower_solver.h"
 #include "../utilities/follower_cplex_solver.h"
 #include "../utilities/follower_light_solver.h"
+#include "../utilities/cch_follower_solver.h"
+#include "../utilities/skeleton_follower_solver.h"
 #include "../problem_generator.h"
 #include "data_generator.h"
 
 #include <chrono>
+#include <thread>
+#include <algorithm>
 
 using namespace std;
 
+// Statistics of the commodities sharing an origin
+static void print_origin_groups(const follower_solver_base& solver) {
+	int num_shared = 0;
+	for (const auto& group : solver.origin_groups)
+		if (group.size() > 1)
+			num_shared += group.size();
+
+	cout << "Commodities: " << solver.K << ", distinct origins: " << solver.origin_groups.size() <<
+		" (duplication factor " << (double)solver.K / solver.origin_groups.size() <<
+		", " << num_shared << " commodities sharing an origin)" << endl;
+}
+
 void follower_solver_perftest() {
 	cout << "Follower solver performance test..." << endl;
 
@@ -35,6 +51,7 @@ void follower_solver_perftest() {
 
 	cout << "Outer measurement: " << time * 1000 / TOTAL << " ms" << endl;
 	cout << "Inner measurement: " << solver.time * 1000 / TOTAL << " ms" << endl;
+	print_origin_groups(solver);
 }
 
 void follower_cplex_solver_perftest() {
@@ -65,6 +82,7 @@ void follower_cplex_solver_perftest() {
 
 	cout << "Outer measurement: " << time * 1000 / TOTAL << " ms" << endl;
 	cout << "Inner measurement: " << solver.time * 1000 / TOTAL << " ms" << endl;
+	print_origin_groups(solver);
 }
 
 void follower_light_solver_perftest() {
@@ -94,6 +112,101 @@ void follower_light_solver_perftest() {
 
 	cout << "Outer measurement: " << time * 1000 / TOTAL << " ms" << endl;
 	cout << "Inner measurement: " << solver.time * 1000 / TOTAL << " ms" << endl;
+	print_origin_groups(solver);
+}
+
+void follower_cch_solver_perftest() {
+	cout << "Follower CCH solver performance test..." << endl;
+
+	const int SAMPLES = 100;
+	const int REPEAT = 10;
+	const int TOTAL = SAMPLES * REPEAT;
+
+	const vector<pair<int, int>> sizes = { {5, 12}, {20, 30}, {50, 60} };
+
+	auto seed = chrono::high_resolution_clock::now().time_since_epoch().count();
+	auto random_engine = default_random_engine(seed);
+
+	for (const auto& size : sizes) {
+		cout << size.first << " x " << size.second << " grid:" << endl;
+
+		problem prob(random_grid_problem(size.first, size.second, 40, 0.2, random_engine));
+
+		auto pre_start = chrono::high_resolution_clock::now();
+		cch_follower_solver cch_solver(prob);
+		auto pre_end = chrono::high_resolution_clock::now();
+		double pre_time = chrono::duration<double>(pre_end - pre_start).count();
+
+		follower_light_solver light_solver(prob);
+		vector<vector<cost_type>> tolls_data = generate_tolls_data(light_solver, SAMPLES, random_engine);
+
+		// Each toll vector is solved REPEAT times, only the first one needs customization
+		LOOP(i, SAMPLES) {
+			LOOP(j, REPEAT) {
+				light_solver.solve(tolls_data[i]);
+				cch_solver.solve(tolls_data[i]);
+			}
+		}
+
+		cout << "  CCH preprocessing: " << pre_time * 1000 << " ms (ordering " << cch_solver.cch.order_time * 1000 <<
+			" ms, contraction " << cch_solver.cch.contract_time * 1000 << " ms, " <<
+			cch_solver.cch.edge_lo.size() << " edges, " << cch_solver.cch.triangles.size() << " triangles)" << endl;
+		cout << "  CCH customization: " << cch_solver.customize_time * 1000 / SAMPLES << " ms per toll vector (" <<
+			cch_solver.num_updated_edges / SAMPLES << " edges updated)" << endl;
+		cout << "  CCH solver: " << cch_solver.time * 1000 / TOTAL << " ms" << endl;
+		cout << "  Light solver: " << light_solver.time * 1000 / TOTAL << " ms" << endl;
+	}
+}
+
+void follower_skeleton_solver_perftest() {
+	cout << "Follower skeleton solver performance test..." << endl;
+
+	const int SAMPLES = 100;
+	const int REPEAT = 10;
+	const int TOTAL = SAMPLES * REPEAT;
+
+	const vector<pair<int, int>> sizes = { {5, 12}, {20, 30}, {50, 60} };
+
+	auto seed = chrono::high_resolution_clock::now().time_since_epoch().count();
+	auto random_engine = default_random_engine(seed);
+
+	for (const auto& size : sizes) {
+		cout << size.first << " x " << size.second << " grid:" << endl;
+
+		problem prob(random_grid_problem(size.first, size.second, 40, 0.2, random_engine));
+
+		skeleton_follower_solver skel_solver(prob);
+		follower_light_solver light_solver(prob);
+		vector<vector<cost_type>> tolls_data = generate_tolls_data(light_solver, SAMPLES, random_engine);
+
+		// Skeleton paths may differ from the light solver ones on ties, only the costs are compared
+		int num_wrong = 0;
+		LOOP(i, SAMPLES) {
+			LOOP(j, REPEAT) {
+				auto light_paths = light_solver.solve(tolls_data[i]);
+				auto skel_paths = skel_solver.solve(tolls_data[i]);
+
+				LOOP(k, light_solver.K) {
+					cost_type light_cost = light_solver.get_cost(light_paths[k], tolls_data[i]);
+					cost_type skel_cost = light_solver.get_cost(skel_paths[k], tolls_data[i]);
+					if (abs(light_cost - skel_cost) > 1e-6 * max<cost_type>(1, abs(light_cost)))
+						num_wrong++;
+				}
+			}
+		}
+
+		double num_nodes = 0, num_arcs = 0;
+		for (const auto& graph : skel_solver.graphs) {
+			num_nodes += graph.V;
+			num_arcs += graph.Eall.size();
+		}
+
+		cout << "  Skeleton preprocessing: " << skel_solver.preprocess_time * 1000 << " ms (" <<
+			num_nodes / skel_solver.K << " nodes, " << num_arcs / skel_solver.K << " arcs on average, original " <<
+			boost::num_vertices(prob.graph) << " nodes, " << boost::num_edges(prob.graph) << " arcs)" << endl;
+		cout << "  Skeleton solver: " << skel_solver.time * 1000 / TOTAL << " ms (" << num_wrong << " wrong costs)" << endl;
+		cout << "  Light solver: " << light_solver.time * 1000 / TOTAL << " ms" << endl;
+	}
 }
 
 void follower_solver_acctest() {
@@ -110,6 +223,7 @@ void follower_solver_acctest() {
 	follower_solver solver1(prob);
 	follower_cplex_solver solver2(env, prob);
 	follower_light_solver solver3(prob);
+	cch_follower_solver solver4(prob);
 
 	vector<vector<cost_type>> tolls_data = generate_tolls_data(solver1, SAMPLES, random_engine);
 
@@ -119,6 +233,7 @@ void follower_solver_acctest() {
 		auto paths1 = solver1.solve(tolls_data[i]);
 		auto paths2 = solver2.solve(tolls_data[i]);
 		auto paths3 = solver3.solve(tolls_data[i]);
+		auto paths4 = solver4.solve(tolls_data[i]);
 
 		/*vector<cost_type> cost1, cost2, cost3;
 		transform(paths1.begin(), paths1.end(), back_inserter(cost1), [&](const auto& p) { return solver1.get_cost(p, tolls_data[i]); });
@@ -139,6 +254,170 @@ void follower_solver_acctest() {
 			}
 			return;
 		}
+		if (paths1 != paths4) {
+			LOOP(k, solver1.K) {
+				if (paths1[k] != paths4[k])
+					cerr << "CCH solver gives wrong result at commodity " << k << endl;
+			}
+			return;
+		}
 	}
 	cout << "Follower solvers produced accurate results" << endl;
 }
+
+void follower_light_solver_radix_acctest() {
+	cout << "Follower light solver (radix heap) accuracy test..." << endl;
+
+	const int SAMPLES = 1000;
+
+	auto seed = chrono::high_resolution_clock::now().time_since_epoch().count();
+	auto random_engine = default_random_engine(seed);
+
+	problem prob(random_grid_problem(5, 12, 40, 0.2, random_engine));
+
+	follower_solver solver1(prob);
+	follower_light_solver solver2(prob, light_graph::RADIX_HEAP);
+
+	vector<vector<cost_type>> tolls_data = generate_tolls_data(solver1, SAMPLES, random_engine);
+
+	int num_ties = 0;
+
+	LOOP(i, SAMPLES) {
+		auto paths1 = solver1.solve(tolls_data[i]);
+		auto paths2 = solver2.solve(tolls_data[i]);
+
+		LOOP(k, solver1.K) {
+			if (paths1[k] == paths2[k])
+				continue;
+
+			// Different paths are accepted only if they tie up to the rounding error
+			cost_type cost1 = solver1.get_cost(paths1[k], tolls_data[i]);
+			cost_type cost2 = solver1.get_cost(paths2[k], tolls_data[i]);
+			double tolerance = paths2[k].size() / solver2.lgraph.radix_scale + 1e-3;
+
+			if (abs(cost1 - cost2) > tolerance) {
+				cerr << "Radix heap gives wrong result at commodity " << k <<
+					" (" << cost2 << " != " << cost1 << ")" << endl;
+				return;
+			}
+			num_ties++;
+		}
+	}
+
+	cout << "Follower light solver (radix heap) produced accurate results (" << num_ties << " ties)" << endl;
+}
+
+void follower_light_solver_thread_perftest() {
+	cout << "Follower light solver multi-thread performance test..." << endl;
+
+	const int SAMPLES = 100;
+	const int REPEAT = 10;
+	const int TOTAL = SAMPLES * REPEAT;
+
+	const int max_threads = max(1u, thread::hardware_concurrency());
+
+	auto seed = chrono::high_resolution_clock::now().time_since_epoch().count();
+	auto random_engine = default_random_engine(seed);
+
+	problem prob(random_grid_problem(20, 30, 400, 0.2, random_engine));
+	follower_light_solver ref_solver(prob);
+	vector<vector<cost_type>> tolls_data = generate_tolls_data(ref_solver, SAMPLES, random_engine);
+
+	vector<vector<follower_light_solver::path>> ref_paths;
+	LOOP(i, SAMPLES) {
+		LOOP(j, REPEAT) ref_solver.solve(tolls_data[i]);
+		ref_paths.push_back(ref_solver.solve(tolls_data[i]));
+	}
+	cout << "  1 thread: " << ref_solver.time * 1000 / (TOTAL + SAMPLES) << " ms" << endl;
+
+	for (int num_threads = 2; num_threads <= max_threads; num_threads *= 2) {
+		follower_light_solver solver(prob);
+		solver.set_num_threads(num_threads);
+
+		LOOP(i, SAMPLES) {
+			LOOP(j, REPEAT) {
+				// Results must not depend on the number of threads
+				if (solver.solve(tolls_data[i]) != ref_paths[i]) {
+					cerr << "Multi-thread solver gives a different result with " << num_threads << " threads" << endl;
+					return;
+				}
+			}
+		}
+
+		cout << "  " << num_threads << " threads: " << solver.time * 1000 / TOTAL << " ms" << endl;
+	}
+	print_origin_groups(ref_solver);
+}
+
+void follower_solver_batch_perftest() {
+	cout << "Follower solver batch evaluation performance test..." << endl;
+
+	const int SAMPLES = 500;
+
+	auto seed = chrono::high_resolution_clock::now().time_since_epoch().count();
+	auto random_engine = default_random_engine(seed);
+
+	problem prob(random_grid_problem(5, 12, 40, 0.2, random_engine));
+	follower_light_solver solver(prob);
+	vector<vector<cost_type>> tolls_data = generate_tolls_data(solver, SAMPLES, random_engine);
+
+	// One solve and one walk per path and toll vector
+	auto start = chrono::high_resolution_clock::now();
+
+	vector<cost_type> revenues(SAMPLES, 0);
+	vector<follower_light_solver::path> all_paths;
+	LOOP(i, SAMPLES) {
+		auto paths = solver.solve(tolls_data[i]);
+		LOOP(k, solver.K) {
+			const auto& path = paths[k];
+			for (int j = 0; j + 1 < (int)path.size(); j++) {
+				auto edge = EDGE_FROM_SRC_DST(prob, path[j], path[j + 1]);
+				if (prob.is_tolled_map[edge])
+					revenues[i] += tolls_data[i][EDGE_TO_A1(prob, edge)] * prob.commodities[k].demand;
+			}
+		}
+		all_paths.insert(all_paths.end(), paths.begin(), paths.end());
+	}
+
+	auto end = chrono::high_resolution_clock::now();
+	double naive_time = chrono::duration<double>(end - start).count();
+
+	// Batch
+	start = chrono::high_resolution_clock::now();
+	auto result = solver.solve_batch(tolls_data);
+	end = chrono::high_resolution_clock::now();
+	double batch_time = chrono::duration<double>(end - start).count();
+
+	LOOP(i, SAMPLES) {
+		if (abs(result.revenues[i] - revenues[i]) > 1e-3 * max<cost_type>(1, abs(revenues[i]))) {
+			cerr << "Batch revenue mismatch at toll vector " << i <<
+				" (" << result.revenues[i] << " != " << revenues[i] << ")" << endl;
+			return;
+		}
+	}
+
+	// Costs of the distinct paths under all toll vectors
+	sort(all_paths.begin(), all_paths.end());
+	all_paths.erase(unique(all_paths.begin(), all_paths.end()), all_paths.end());
+
+	start = chrono::high_resolution_clock::now();
+	cost_type naive_sum = 0;
+	for (const auto& path : all_paths)
+		LOOP(i, SAMPLES) naive_sum += solver.get_cost(path, tolls_data[i]);
+	end = chrono::high_resolution_clock::now();
+	double naive_cost_time = chrono::duration<double>(end - start).count();
+
+	start = chrono::high_resolution_clock::now();
+	auto costs = solver.get_costs(all_paths, tolls_data);
+	end = chrono::high_resolution_clock::now();
+	double batch_cost_time = chrono::duration<double>(end - start).count();
+
+	cost_type batch_sum = 0;
+	for (const auto& row : costs)
+		for (cost_type cost : row) batch_sum += cost;
+
+	cout << "Solve and revenue: " << naive_time * 1000 / SAMPLES << " ms per toll vector, batch " <<
+		batch_time * 1000 / SAMPLES << " ms" << endl;
+	cout << "Costs of " << all_paths.size() << " distinct paths: " << naive_cost_time * 1000 << " ms, batch " <<
+		batch_cost_time * 1000 << " ms (sums " << naive_sum << " / " << batch_sum << ")" << endl;
+}
@@ -3,6 +3,8 @@
 #include "../problem_generator.h"
 
 #include <chrono>
+#include <map>
+#include <queue>
 #include <boost/graph/dijkstra_shortest_paths.hpp>
 
 using namespace std;
@@ -76,6 +78,60 @@ void light_graph_dijkstra_acctest() {
 	cout << "Light graph Dijkstra produced accurate results" << endl;
 }
 
+// Reference implementation on std::map adjacency lists (the former light_graph layout)
+static vector<int> map_shortest_path(const light_graph& lgraph, const vector<map<int, int>>& E, int from, int to) {
+	using cipair = std::pair<cost_type, int>;
+
+	vector<int> parents(lgraph.V, -1);
+	vector<cost_type> distances(lgraph.V, numeric_limits<cost_type>::infinity());
+	vector<bool> closed(lgraph.V, false);
+
+	std::priority_queue<cipair, vector<cipair>, std::greater<cipair>> queue;
+
+	queue.push(make_pair(0, from));
+	distances[from] = 0;
+	parents[from] = from;
+
+	while (!queue.empty()) {
+		int src = queue.top().second;
+		if (src == to)
+			break;
+		queue.pop();
+
+		if (closed[src])
+			continue;
+
+		cost_type curr_dist = distances[src];
+		for (auto it = E[src].begin(); it != E[src].end(); ++it) {
+			const light_edge& edge = lgraph.Eall[it->second];
+			int dst = it->first;
+			cost_type new_dist = curr_dist + edge.cost + edge.toll;
+
+			if (new_dist < distances[dst]) {
+				distances[dst] = new_dist;
+				parents[dst] = src;
+				queue.push(make_pair(new_dist, dst));
+			}
+		}
+
+		closed[src] = true;
+	}
+
+	vector<int> p;
+	if (queue.empty())
+		return p;
+
+	int curr = to;
+	while (curr != from) {
+		p.push_back(curr);
+		curr = parents[curr];
+	}
+	p.push_back(from);
+	std::reverse(p.begin(), p.end());
+
+	return p;
+}
+
 void light_graph_dijkstra_perftest() {
 	using path = vector<int>;
 
@@ -114,6 +170,49 @@ void light_graph_dijkstra_perftest() {
 	auto end1 = chrono::high_resolution_clock::now();
 	double time1 = chrono::duration<double>(end1 - start1).count();
 
+	// Radix heap engine
+	vector<light_graph> rgraphs(lgraphs);
+	for (auto& rgraph : rgraphs)
+		rgraph.heap = light_graph::RADIX_HEAP;
+
+	auto start4 = chrono::high_resolution_clock::now();
+
+	LOOP(i, SAMPLES) {
+		int from = froms[i], to = tos[i];
+		auto& rgraph = rgraphs[i];
+
+		LOOP(j, REPEAT) {
+			path p = rgraph.shortest_path(from, to);
+		}
+	}
+
+	auto end4 = chrono::high_resolution_clock::now();
+	double time4 = chrono::duration<double>(end4 - start4).count();
+
+	// Map adjacency lists for comparison
+	vector<vector<map<int, int>>> map_adjs;
+	for (const auto& lgraph : lgraphs) {
+		vector<map<int, int>> E(lgraph.V);
+		LOOP(a, (int)lgraph.Eall.size())
+			E[lgraph.Eall[a].src].emplace(lgraph.Eall[a].dst, a);
+		map_adjs.push_back(std::move(E));
+	}
+
+	auto start3 = chrono::high_resolution_clock::now();
+
+	LOOP(i, SAMPLES) {
+		int from = froms[i], to = tos[i];
+		auto& lgraph = lgraphs[i];
+		auto& E = map_adjs[i];
+
+		LOOP(j, REPEAT) {
+			path p = map_shortest_path(lgraph, E, from, to);
+		}
+	}
+
+	auto end3 = chrono::high_resolution_clock::now();
+	double time3 = chrono::duration<double>(end3 - start3).count();
+
 	auto start2 = chrono::high_resolution_clock::now();
 
 	LOOP(i, SAMPLES) {
@@ -142,10 +241,90 @@ void light_graph_dijkstra_perftest() {
 	auto end2 = chrono::high_resolution_clock::now();
 	double time2 = chrono::duration<double>(end2 - start2).count();
 
-	cout << "Light graph: " << time1 * 1000 / TOTAL << " ms" << endl;
+	cout << "Light graph (CSR): " << time1 * 1000 / TOTAL << " ms" << endl;
+	cout << "Light graph (map): " << time3 * 1000 / TOTAL << " ms" << endl;
+	cout << "Light graph (radix): " << time4 * 1000 / TOTAL << " ms" << endl;
 	cout << "Boost graph: " << time2 * 1000 / TOTAL << " ms" << endl;
 }
 
+void light_graph_point_to_point_perftest() {
+	using path = vector<int>;
+
+	cout << "Light graph point-to-point search performance test..." << endl;
+
+	const int SAMPLES = 20;
+	const int REPEAT = 20;
+	const int TOTAL = SAMPLES * REPEAT;
+	const int NUM_COMMODITIES = 40;
+
+	const vector<pair<int, int>> sizes = { {5, 12}, {20, 30}, {50, 60} };
+	const vector<pair<light_graph::search_type, string>> modes = {
+		{ light_graph::UNIDIRECTIONAL, "Unidirectional" },
+		{ light_graph::BIDIRECTIONAL, "Bidirectional" },
+		{ light_graph::ASTAR, "A*" }
+	};
+
+	auto seed = chrono::high_resolution_clock::now().time_since_epoch().count();
+	auto random_engine = default_random_engine(seed);
+
+	for (const auto& size : sizes) {
+		cout << size.first << " x " << size.second << " grid:" << endl;
+
+		vector<light_graph> lgraphs;
+		vector<vector<commodity>> comms;
+
+		LOOP(i, SAMPLES) {
+			problem prob = random_grid_problem(size.first, size.second, NUM_COMMODITIES, 0.2, random_engine);
+			light_graph lgraph(prob.graph);
+
+			// Random tolls
+			for (auto& edge : lgraph.Eall) {
+				if (edge.is_tolled)
+					edge.toll = uniform_real_distribution<cost_type>(0, 10)(random_engine);
+			}
+
+			lgraphs.push_back(std::move(lgraph));
+			comms.push_back(prob.commodities);
+		}
+
+		vector<vector<path>> ref_paths(SAMPLES);
+
+		for (const auto& mode : modes) {
+			for (auto& lgraph : lgraphs)
+				lgraph.search = mode.first;
+
+			auto start = chrono::high_resolution_clock::now();
+
+			LOOP(i, SAMPLES) {
+				LOOP(j, REPEAT) {
+					for (const auto& comm : comms[i])
+						path p = lgraphs[i].shortest_path(comm.origin, comm.destination);
+				}
+			}
+
+			auto end = chrono::high_resolution_clock::now();
+			double time = chrono::duration<double>(end - start).count();
+
+			// Check the costs against the unidirectional search
+			int num_wrong = 0;
+			LOOP(i, SAMPLES) {
+				LOOP(k, NUM_COMMODITIES) {
+					path p = lgraphs[i].shortest_path(comms[i][k].origin, comms[i][k].destination);
+					if (mode.first == light_graph::UNIDIRECTIONAL)
+						ref_paths[i].push_back(p);
+					else if (abs(lgraphs[i].get_path_cost(p) - lgraphs[i].get_path_cost(ref_paths[i][k])) > 0.01)
+						num_wrong++;
+				}
+			}
+
+			cout << "  " << mode.second << ": " << time * 1000 / TOTAL << " ms per " << NUM_COMMODITIES << " queries";
+			if (num_wrong > 0)
+				cout << " (" << num_wrong << " wrong costs)";
+			cout << endl;
+		}
+	}
+}
+
 void light_graph_yen_acctest() {
 	using path = vector<int>;
 
@@ -803,6 +982,20 @@ void light_graph_bilevel_feasible_2_acctest() {
 	cout << "Light graph Bilevel feasible v2 produced accurate results" << endl;
 }
 
+// Undo log statistics of the enumerations since the last call (compared to a full O(V + E) reset per spur)
+static void print_temp_state_stats(vector<light_graph>& lgraphs) {
+	long long spurs = 0, restored = 0, full = 0;
+	for (auto& lgraph : lgraphs) {
+		spurs += lgraph.spur_count;
+		restored += lgraph.temp_restore_count;
+		full += lgraph.spur_count * (lgraph.V + lgraph.Eall.size());
+		lgraph.spur_count = lgraph.temp_restore_count = 0;
+	}
+
+	cout << "  Spurs: " << spurs << ", restored entries per spur: " << (double)restored / max(spurs, 1LL) <<
+		" (full reset: " << (double)full / max(spurs, 1LL) << ")" << endl;
+}
+
 void light_graph_bilevel_feasible_2_perftest() {
 	using path = vector<int>;
 
@@ -845,6 +1038,7 @@ void light_graph_bilevel_feasible_2_perftest() {
 	auto time = chrono::duration<double>(end - start).count();
 
 	cout << "Version 1 (max 200): " << time * 1000 / TOTAL << " ms" << endl;
+	print_temp_state_stats(lgraphs);
 
 	start = chrono::high_resolution_clock::now();
 
@@ -863,6 +1057,7 @@ void light_graph_bilevel_feasible_2_perftest() {
 	time = chrono::duration<double>(end - start).count();
 
 	cout << "Version 2 (max 1000): " << time * 1000 / TOTAL << " ms" << endl;
+	print_temp_state_stats(lgraphs);
 
 	start = chrono::high_resolution_clock::now();
 
@@ -881,6 +1076,7 @@ void light_graph_bilevel_feasible_2_perftest() {
 	time = chrono::duration<double>(end - start).count();
 
 	cout << "Version 2u (max 1000): " << time * 1000 / TOTAL << " ms" << endl;
+	print_temp_state_stats(lgraphs);
 
 	cout << "Average num paths 1: " << std::accumulate(sizes1.begin(), sizes1.end(), 0) / SAMPLES << endl;
 	cout << "Average num paths 2: " << std::accumulate(sizes2.begin(), sizes2.end(), 0) / SAMPLES << endl;
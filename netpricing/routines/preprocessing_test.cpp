@@ -3,6 +3,7 @@
 
 #include "../hybrid/preprocessors/path_preprocessor.h"
 #include "../hybrid/preprocessors/spgm_preprocessor.h"
+#include "../utilities/distance_oracle.h"
 
 #include <chrono>
 
@@ -25,9 +26,12 @@ void path_vs_spgm_preprocessors_compare() {
 		probs.emplace_back(random_grid_problem(5, 12, 40, 0.2, random_engine));
 	}
 
+	long long hits = 0, misses = 0;
+
 	LOOP(i, SAMPLES) {
 		problem& prob = probs[i];
 		light_graph lgraph(prob.graph);
+		distance_oracle oracle(prob);
 
 		const char* TAB = "\t";
 
@@ -51,6 +55,7 @@ void path_vs_spgm_preprocessors_compare() {
 			}
 
 			spgm_preprocessor sproc;
+			sproc.oracle = &oracle;
 
 			std::cout.setstate(std::ios_base::failbit);
 			auto info2 = sproc.preprocess(prob, k);
@@ -58,5 +63,12 @@ void path_vs_spgm_preprocessors_compare() {
 
 			cout << info2.V.size() << TAB << info2.A.size() << TAB << info2.A1.size() << endl;
 		}
+
+		hits += oracle.hits;
+		misses += oracle.misses;
 	}
+
+	// On stderr, the statistics on stdout stay tabular
+	cerr << "Distance cache: " << hits << " hits, " << misses << " misses (" <<
+		100.0 * hits / max(hits + misses, 1LL) << "% hit rate)" << endl;
 }
\ No newline at end of file
@@ -5,7 +5,12 @@
 void follower_solver_perftest();
 void follower_cplex_solver_perftest();
 void follower_light_solver_perftest();
+void follower_cch_solver_perftest();
+void follower_skeleton_solver_perftest();
 void follower_solver_acctest();
+void follower_light_solver_radix_acctest();
+void follower_light_solver_thread_perftest();
+void follower_solver_batch_perftest();
 
 void inverse_solver_acctest();
 void inverse_solver_perftest();
@@ -14,6 +19,7 @@ void tolls_heuristic_perftest();
 
 void light_graph_dijkstra_acctest();
 void light_graph_dijkstra_perftest();
+void light_graph_point_to_point_perftest();
 void light_graph_yen_acctest();
 void light_graph_yen_perftest();
 void light_graph_toll_unique_acctest();
@@ -32,8 +38,9 @@ void light_graph_bilevel_feasible_3_perftest();
 
 void path_vs_spgm_preprocessors_compare();
 
-void data_numpaths_stats(std::string prefix, int numpaths);
-void data_pathenum_stats(std::string prefix, int numpaths);
-void data_preprocessing_stats(std::string prefix, int numpaths);
+void data_numpaths_stats(std::string prefix, int numpaths, std::string cache_dir = "");
+void data_pathenum_stats(std::string prefix, int numpaths, std::string cache_dir = "");
+void data_preprocessing_stats(std::string prefix, int numpaths, std::string cache_dir = "");
+void data_preprocessing_perftest(std::string prefix, int numpaths, std::string cache_dir = "");
 void data_dimensions_stats(std::string prefix);
-void data_path_spgm_preprocessing_stats(std::string prefix, int numpaths);
+void data_path_spgm_preprocessing_stats(std::string prefix, int numpaths, std::string cache_dir = "");
@@ -0,0 +1,230 @@
+#include "big_mn_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include "../problem.h"
+#include "../macros.h"
+#include "../graph/light_graph.h"
+#include "../hybrid/preprocessors/spgm_preprocessor.h"
+#include "distance_oracle.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+// Distinct nodes in order of first appearance, slot[node] is the position of node (-1 if absent)
+static void add_node(vector<int>& nodes, vector<int>& slot, int node)
+{
+	if (slot[node] < 0) {
+		slot[node] = nodes.size();
+		nodes.push_back(node);
+	}
+}
+
+// Graph of the arcs at null tolls (the toll-free arcs only if !tolled_arcs)
+// light_graph keeps one arc per (src, dst), so the cheapest of parallel arcs is taken here
+static light_graph null_toll_graph(const problem& prob, bool tolled_arcs)
+{
+	int V = boost::num_vertices(prob.graph);
+	light_graph graph(V);
+
+	// prob.out_dst is sorted by destination within each source, parallel arcs are adjacent
+	LOOP(i, V) {
+		for (int first = prob.out_begin[i]; first < prob.out_begin[i + 1];) {
+			int j = prob.out_dst[first];
+			cost_type cost = numeric_limits<cost_type>::infinity();
+
+			int last = first;
+			for (; last < prob.out_begin[i + 1] && prob.out_dst[last] == j; last++) {
+				int a = prob.out_a[last];
+				if (tolled_arcs || prob.a_to_a2[a] >= 0)
+					cost = min(cost, prob.cost_map[prob.a_to_edge[a]]);
+			}
+			first = last;
+
+			if (isfinite(cost)) {
+				graph.Eall.emplace_back(light_edge{
+					.index = -1,
+					.src = i,
+					.dst = j,
+					.cost = cost,
+					.is_tolled = false,
+					.toll = 0,
+					.enabled = true,
+					.temp_enabled = true
+											   });
+			}
+		}
+	}
+
+	graph.build_adjacency();
+	return graph;
+}
+
+static bool has_parallel_arcs(const problem& prob)
+{
+	int V = boost::num_vertices(prob.graph);
+	LOOP(i, V) {
+		for (int j = prob.out_begin[i] + 1; j < prob.out_begin[i + 1]; j++)
+			if (prob.out_dst[j] == prob.out_dst[j - 1])
+				return true;
+	}
+	return false;
+}
+
+big_mn_engine::big_mn_engine(int num_threads, bool spgm_bounds) :
+	num_threads(num_threads > 0 ? num_threads : max(1u, thread::hardware_concurrency())),
+	spgm_bounds(spgm_bounds)
+{
+}
+
+big_mn_engine::result big_mn_engine::compute(const problem& prob) const
+{
+	int V = boost::num_vertices(prob.graph);
+	int K = prob.commodities.size();
+	int A1 = prob.a1_to_a.size();
+
+	light_graph nulltoll_graph = null_toll_graph(prob, true);
+	light_graph tollfree_graph = null_toll_graph(prob, false);
+
+	// Distinct endpoints
+	vector<int> origins, dests, tails;
+	vector<int> origin_slot(V, -1), dest_slot(V, -1), tail_slot(V, -1);
+	LOOP(k, K) {
+		add_node(origins, origin_slot, prob.commodities[k].origin);
+		add_node(dests, dest_slot, prob.commodities[k].destination);
+	}
+
+	vector<vector<int>> tail_arcs;
+	LOOP(a, A1) {
+		int i = prob.arc_src[A1_TO_A(prob, a)];
+		add_node(tails, tail_slot, i);
+		tail_arcs.resize(tails.size());
+		tail_arcs[tail_slot[i]].push_back(a);
+	}
+
+	int O = origins.size();
+	int D = dests.size();
+	int T = tails.size();
+
+	// Trees from the origins, to the destinations, and toll-free cost of each tolled arc endpoints
+	vector<cost_array> nulltoll_o(O), tollfree_o(O), nulltoll_d(D), tollfree_d(D);
+	cost_array tollfree_arc(A1);
+
+	thread_pool pool(num_threads);
+	pool.run(2 * O + 2 * D + T, [&](int job) {
+		if (job < O) nulltoll_o[job] = nulltoll_graph.price_from_src(origins[job]);
+		else if ((job -= O) < O) tollfree_o[job] = tollfree_graph.price_from_src(origins[job]);
+		else if ((job -= O) < D) nulltoll_d[job] = nulltoll_graph.price_to_dst(dests[job]);
+		else if ((job -= D) < D) tollfree_d[job] = tollfree_graph.price_to_dst(dests[job]);
+		else {
+			// Only the heads are read, the labels stay in the workspace (a single head stops the search)
+			job -= D;
+			const vector<int>& arcs = tail_arcs[job];
+			int to = arcs.size() == 1 ? prob.arc_dst[A1_TO_A(prob, arcs[0])] : -1;
+
+			light_workspace& ws = light_workspace::local();
+			tollfree_graph.dijkstra(ws, tails[job], to);
+			for (int a : arcs)
+				tollfree_arc[a] = ws.distance(prob.arc_dst[A1_TO_A(prob, a)]);
+		}
+	});
+
+	// Commodity bounds
+	result res;
+	res.obj_upper_bound = 0;
+
+	cost_array tollfree_od(K);
+	LOOP(k, K) {
+		const commodity& comm = prob.commodities[k];
+		int o = origin_slot[comm.origin];
+		tollfree_od[k] = tollfree_o[o][comm.destination];
+		res.obj_upper_bound += (tollfree_od[k] - nulltoll_o[o][comm.destination]) * comm.demand;
+	}
+
+	// The SPGM does not tell parallel arcs apart, its bounds are skipped for such graphs
+	const bool use_spgm = spgm_bounds && !has_parallel_arcs(prob);
+
+	vector<cost_array> spgm_m;
+	if (use_spgm)
+		spgm_m = spgm_big_m(prob, tollfree_od, pool);
+
+	// Big M and N, one tolled arc per job
+	res.big_m.assign(K, cost_array(A1));
+	res.big_n.assign(A1, -numeric_limits<cost_type>::infinity());
+
+	pool.run(A1, [&](int a) {
+		SRC_DST_FROM_A1(prob, a);
+		int i = src;
+		int j = dst;
+		cost_type c = prob.cost_map[edge];
+
+		LOOP(k, K) {
+			const commodity& comm = prob.commodities[k];
+			const cost_array& nulltoll_oi = nulltoll_o[origin_slot[comm.origin]];
+			const cost_array& tollfree_oi = tollfree_o[origin_slot[comm.origin]];
+			const cost_array& nulltoll_jd = nulltoll_d[dest_slot[comm.destination]];
+			const cost_array& tollfree_id = tollfree_d[dest_slot[comm.destination]];
+
+			cost_type& big_m = res.big_m[k][a];
+
+			// The commodity never reaches the arc, or never reaches its destination after it
+			if (!isfinite(nulltoll_oi[i]) || !isfinite(nulltoll_jd[j]))
+				big_m = 0;
+			else {
+				cost_type m1, m2, m3, m4;
+				m1 = tollfree_arc[a] - c;
+				m2 = tollfree_oi[j] - nulltoll_oi[i] - c;
+				m3 = tollfree_id[i] - c - nulltoll_jd[j];
+				m4 = tollfree_od[k] - nulltoll_oi[i] - c - nulltoll_jd[j];
+
+				big_m = max((cost_type)0, min({ m1, m2, m3, m4 }));
+			}
+
+			if (use_spgm)
+				big_m = min(big_m, spgm_m[k][a]);
+
+			res.big_n[a] = max(res.big_n[a], big_m);
+		}
+	});
+
+	return res;
+}
+
+vector<big_mn_engine::cost_array> big_mn_engine::spgm_big_m(const problem& prob, const cost_array& tollfree_od,
+															 thread_pool& pool) const
+{
+	int K = prob.commodities.size();
+	int A1 = prob.a1_to_a.size();
+
+	// Arcs outside the SPGM of a commodity are never used by it, their bound stays 0
+	vector<cost_array> bounds(K, cost_array(A1, 0));
+	distance_oracle oracle(prob);
+
+	pool.run(K, [&](int k) {
+		ostream null_log(nullptr);
+		spgm_preprocessor preproc;
+		preproc.log = &null_log;
+		preproc.oracle = &oracle;
+
+		// The perturbation lengthens the toll-free arcs, which would overestimate the distances and cut off optima
+		preproc.perturb = false;
+
+		preprocess_info info = preproc.preprocess(prob, k);
+		light_graph graph = info.build_graph();
+
+		const commodity& comm = prob.commodities[k];
+		cost_array from_orig = graph.price_from_src(comm.origin);
+		cost_array to_dest = graph.price_to_dst(comm.destination);
+
+		for (int a : info.A1) {
+			SRC_DST_FROM_A1(prob, a);
+			cost_type c = prob.cost_map[edge];
+			bounds[k][a] = max((cost_type)0, tollfree_od[k] - from_orig[src] - c - to_dest[dst]);
+		}
+	});
+
+	return bounds;
+}
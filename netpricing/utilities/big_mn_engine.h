@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include "../problem_base.h"
+
+struct problem;
+struct thread_pool;
+
+// Big M and N of a problem, computed in parallel on light graphs
+// Trees are computed once per distinct tolled arc tail (toll-free), origin and destination (both modes, reversed
+// for destinations), instead of two per tolled arc and two per commodity
+struct big_mn_engine
+{
+	using cost_array = problem_base::cost_array;
+
+	struct result {
+		problem_base::big_m_type big_m;
+		problem_base::big_n_type big_n;
+
+		// Sum of the commodity revenues at zero tolls against the toll-free paths
+		cost_type obj_upper_bound;
+	};
+
+	int num_threads;		// 0 = one per hardware thread
+
+	// Also bound M by the distances on the SPGM of each commodity (tighter, valid as the SPGM keeps the optimal paths)
+	bool spgm_bounds;
+
+	big_mn_engine(int num_threads = 1, bool spgm_bounds = false);
+
+	result compute(const problem& prob) const;
+
+private:
+	std::vector<cost_array> spgm_big_m(const problem& prob, const cost_array& tollfree_od, thread_pool& pool) const;
+};
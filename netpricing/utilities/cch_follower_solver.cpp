@@ -0,0 +1,55 @@
+#include "cch_follower_solver.h"
+#include "../macros.h"
+
+#include <chrono>
+
+using namespace std;
+using namespace boost;
+
+cch_follower_solver::cch_follower_solver(const problem& prob) :
+	follower_solver_base(prob), lgraph(prob.graph), cch(lgraph),
+	a1_to_arc(A1), current_tolls(A1, 0),
+	customize_time(0), num_updated_edges(0)
+{
+	LOOP(a, A1) {
+		SRC_DST_FROM_A1(prob, a);
+		a1_to_arc[a] = lgraph.arc_index(src, dst);
+	}
+
+	// Initial customization with zero tolls
+	vector<cost_type> weights(lgraph.Eall.size());
+	LOOP(a, (int)lgraph.Eall.size()) weights[a] = lgraph.Eall[a].cost;
+
+	auto start = chrono::high_resolution_clock::now();
+	cch.customize(weights);
+	auto end = chrono::high_resolution_clock::now();
+	customize_time += chrono::duration<double>(end - start).count();
+}
+
+vector<cch_follower_solver::path> cch_follower_solver::solve_impl(const vector<cost_type>& tolls)
+{
+	auto start = chrono::high_resolution_clock::now();
+
+	// Re-customize only the arcs whose tolls changed
+	vector<pair<int, cost_type>> changed;
+	LOOP(a, A1) {
+		if (tolls[a] == current_tolls[a])
+			continue;
+
+		int arc = a1_to_arc[a];
+		changed.emplace_back(arc, lgraph.Eall[arc].cost + tolls[a] * TOLL_PREFERENCE);		// Prefer tolled arcs
+		current_tolls[a] = tolls[a];
+	}
+	num_updated_edges += cch.update(changed);
+
+	auto end = chrono::high_resolution_clock::now();
+	customize_time += chrono::duration<double>(end - start).count();
+
+	vector<path> paths(K);
+
+	LOOP(k, K) {
+		paths[k] = cch.shortest_path(prob.commodities[k].origin, prob.commodities[k].destination);
+	}
+
+	return paths;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "follower_solver_base.h"
+#include "../graph/light_graph.h"
+#include "../graph/cch_graph.h"
+
+struct cch_follower_solver : public follower_solver_base
+{
+	light_graph lgraph;
+	cch_graph cch;
+
+	// Light graph arc of each tolled arc
+	std::vector<int> a1_to_arc;
+
+	// Tolls of the current customization
+	std::vector<cost_type> current_tolls;
+
+	double customize_time;
+	int num_updated_edges;
+
+	cch_follower_solver(const problem& prob);
+
+	virtual std::vector<path> solve_impl(const std::vector<cost_type>& tolls) override;
+};
@@ -0,0 +1,72 @@
+#include "distance_oracle.h"
+
+#include "../problem.h"
+
+using namespace std;
+
+distance_oracle::distance_oracle(const problem& prob) :
+	graph(prob.graph), hits(0), misses(0), memory(0), toll_free_graph(prob.graph)
+{
+	toll_free_graph.set_toll_arcs_enabled(false);
+}
+
+const distance_oracle::tree& distance_oracle::from_src(int src, bool tolls_enabled)
+{
+	return get(src, false, tolls_enabled);
+}
+
+const distance_oracle::tree& distance_oracle::to_dst(int dst, bool tolls_enabled)
+{
+	return get(dst, true, tolls_enabled);
+}
+
+double distance_oracle::hit_rate() const
+{
+	long long total = hits + misses;
+	return total ? (double)hits / total : 0;
+}
+
+void distance_oracle::clear()
+{
+	lock_guard<std::mutex> lock(mutex);
+	trees.clear();
+}
+
+const distance_oracle::tree& distance_oracle::get(int node, bool reversed, bool tolls_enabled)
+{
+	promise<tree> result;
+	shared_future<tree> entry;
+	bool owner = false;
+
+	{
+		lock_guard<std::mutex> lock(mutex);
+		auto it = trees.find(key(node, reversed, tolls_enabled));
+		if (it == trees.end()) {
+			entry = result.get_future().share();
+			trees.emplace(key(node, reversed, tolls_enabled), entry);
+			owner = true;
+		}
+		else
+			entry = it->second;
+	}
+
+	// The tree is computed outside the lock, concurrent requests of the same tree wait on the future
+	if (owner) {
+		misses++;
+		try {
+			tree t;
+			const light_graph& g = tolls_enabled ? graph : toll_free_graph;
+			g.dijkstra(node, t.distances, t.parents, -1, reversed);
+			memory += t.distances.size() * sizeof(cost_type) + t.parents.size() * sizeof(int);
+			result.set_value(std::move(t));
+		}
+		catch (...) {
+			result.set_exception(current_exception());
+		}
+	}
+	else
+		hits++;
+
+	// The future held by the map keeps the value alive
+	return entry.get();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <future>
+#include <atomic>
+
+#include "../typedef.h"
+#include "../graph/light_graph.h"
+
+struct problem;
+
+// Shortest path trees of a problem graph, shared by the commodities and the threads
+// Each (node, direction, toll mode) tree is computed once, the first request computes it and the others wait
+struct distance_oracle
+{
+	struct tree {
+		std::vector<cost_type> distances;
+		std::vector<int> parents;
+	};
+
+	// Graph of the problem, preprocessors given this exact graph may use the oracle
+	light_graph graph;
+
+	// Statistics (memory: bytes of the trees computed so far, kept across clear)
+	std::atomic<long long> hits;
+	std::atomic<long long> misses;
+	std::atomic<size_t> memory;
+
+	distance_oracle(const problem& prob);
+
+	// Trees stay valid until clear() or the end of the oracle
+	const tree& from_src(int src, bool tolls_enabled);
+	const tree& to_dst(int dst, bool tolls_enabled);
+
+	const std::vector<cost_type>& price_from_src(int src, bool tolls_enabled) { return from_src(src, tolls_enabled).distances; }
+	const std::vector<cost_type>& price_to_dst(int dst, bool tolls_enabled) { return to_dst(dst, tolls_enabled).distances; }
+
+	double hit_rate() const;
+
+	// Drop all the trees (one per distinct request, V-sized each), they are computed again if requested
+	void clear();
+
+private:
+	using key = std::tuple<int, bool, bool>;	// Node, reversed, tolls enabled
+
+	light_graph toll_free_graph;
+
+	std::mutex mutex;
+	std::map<key, std::shared_future<tree>> trees;
+
+	const tree& get(int node, bool reversed, bool tolls_enabled);
+};
@@ -75,7 +75,7 @@ vector<follower_cplex_solver::path> follower_cplex_solver::solve_impl(const vect
 	// Add toll
 	LOOP(k, K) LOOP(a, A1) {
 		auto edge = A1_TO_EDGE(prob, a);
-		obj[k].setLinearCoef(x[k][a], prob.cost_map[edge] + tolls[a] * 0.9999);	// Prefer tolled arcs
+		obj[k].setLinearCoef(x[k][a], prob.cost_map[edge] + tolls[a] * TOLL_PREFERENCE);	// Prefer tolled arcs
 	}
 
 	// Solve
@@ -6,23 +6,69 @@
 using namespace std;
 using namespace boost;
 
-follower_light_solver::follower_light_solver(const problem& prob) :
-	follower_solver_base(prob), lgraph(prob.graph) { }
-
-vector<follower_light_solver::path> follower_light_solver::solve_impl(const vector<cost_type>& tolls)
+follower_light_solver::follower_light_solver(const problem& prob, light_graph::heap_type heap) :
+	follower_solver_base(prob), lgraph(prob.graph),
+	toll_overlay(A1, 0), a1_to_index(A1)
 {
-	// Set toll to graph
+	lgraph.heap = heap;
+
 	LOOP(a, A1) {
 		SRC_DST_FROM_A1(prob, a);
-		lgraph.edge(src, dst).toll = tolls[a] * 0.9999;		// Prefer tolled arcs
+		a1_to_index[a] = lgraph.edge(src, dst).index;
 	}
 
+	// Destinations are fixed, so A* potentials are computed once per commodity
+	// (up front, so that the searches only read the cache)
+	if (heap == light_graph::BINARY_HEAP) {
+		lgraph.search = light_graph::ASTAR;
+		for (const auto& comm : prob.commodities)
+			lgraph.potential(comm.destination);
+	}
+}
+
+void follower_light_solver::set_num_threads(int num_threads)
+{
+	if (num_threads == get_num_threads())
+		return;
+
+	if (num_threads > 1)
+		pool = make_unique<thread_pool>(num_threads);
+	else
+		pool.reset();
+}
+
+vector<follower_light_solver::path> follower_light_solver::solve_impl(const vector<cost_type>& tolls)
+{
+	// Set toll to overlay
+	LOOP(a, A1) toll_overlay[a1_to_index[a]] = tolls[a] * TOLL_PREFERENCE;		// Prefer tolled arcs
+
+	// Each commodity writes only its own slot, so the result does not depend on the scheduling
 	vector<path> paths(K);
 
-	LOOP(k, K) {
-		path p = lgraph.shortest_path(prob.commodities[k].origin, prob.commodities[k].destination);
-		paths[k] = std::move(p);
-	}
+	auto solve_group = [&](int g) {
+		const auto& group = origin_groups[g];
+		int orig = prob.commodities[group[0]].origin;
+		light_workspace& ws = light_workspace::local();
+
+		// Single commodity: point-to-point search
+		if (group.size() == 1) {
+			paths[group[0]] = lgraph.shortest_path(ws, orig, prob.commodities[group[0]].destination, &toll_overlay);
+			return;
+		}
+
+		// Shared origin: one shortest path tree for the whole group
+		lgraph.dijkstra(ws, orig, -1, false, &toll_overlay);
+		for (int k : group) {
+			int dest = prob.commodities[k].destination;
+			if (ws.is_reached(dest))
+				paths[k] = lgraph.trace_path(ws, orig, dest);
+		}
+	};
+
+	if (pool)
+		pool->run(origin_groups.size(), solve_group);
+	else
+		LOOP(g, (int)origin_groups.size()) solve_group(g);
 
 	return paths;
 }
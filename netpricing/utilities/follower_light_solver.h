@@ -1,13 +1,26 @@
 #pragma once
 
 #include "follower_solver_base.h"
+#include "thread_pool.h"
 #include "../graph/light_graph.h"
 
+#include <memory>
+
 struct follower_light_solver : public follower_solver_base
 {
 	light_graph lgraph;
 
-	follower_light_solver(const problem& prob);
+	// Tolls of the last solve (indexed by light_edge::index), the graph itself is never modified
+	light_graph::toll_overlay toll_overlay;
+	std::vector<int> a1_to_index;
+
+	// Origin groups are split among the threads (none if single-threaded)
+	std::unique_ptr<thread_pool> pool;
+
+	follower_light_solver(const problem& prob, light_graph::heap_type heap = light_graph::BINARY_HEAP);
+
+	void set_num_threads(int num_threads);
+	int get_num_threads() const { return pool ? pool->size() : 1; }
 
 	virtual std::vector<path> solve_impl(const std::vector<cost_type>& tolls) override;
 };
@@ -20,7 +20,7 @@ vector<follower_solver::path> follower_solver::solve_impl(const vector<cost_type
 	// Add toll to new cost map
 	LOOP(a, A1) {
 		auto edge = A1_TO_EDGE(prob, a);
-		tolled_cost_map[edge] = prob.cost_map[edge] + tolls[a] * 0.9999;	// Prefer tolled arcs
+		tolled_cost_map[edge] = prob.cost_map[edge] + tolls[a] * TOLL_PREFERENCE;	// Prefer tolled arcs
 	}
 
 	vector<path> paths(K);
@@ -29,20 +29,22 @@ vector<follower_solver::path> follower_solver::solve_impl(const vector<cost_type
 	auto cost_map = make_assoc_property_map(tolled_cost_map);
 	auto parent_map = make_iterator_property_map(parents.begin(), index_map);
 
-	LOOP(k, K) {
-		// Find the shortest path
-		int orig = prob.commodities[k].origin;
+	for (const auto& group : origin_groups) {
+		// Find the shortest path tree (shared by all commodities with this origin)
+		int orig = prob.commodities[group[0]].origin;
 		dijkstra_shortest_paths(prob.graph, orig, weight_map(cost_map).predecessor_map(parent_map));
 
-		// Trace back the path
-		int curr = prob.commodities[k].destination;
-		while (curr != orig) {
-			paths[k].push_back(curr);
-			curr = parents[curr];
-		}
-		paths[k].push_back(orig);
+		for (int k : group) {
+			// Trace back the path
+			int curr = prob.commodities[k].destination;
+			while (curr != orig) {
+				paths[k].push_back(curr);
+				curr = parents[curr];
+			}
+			paths[k].push_back(orig);
 
-		std::reverse(paths[k].begin(), paths[k].end());
+			std::reverse(paths[k].begin(), paths[k].end());
+		}
 	}
 
 	return paths;
@@ -1,13 +1,30 @@
 #include "follower_solver_base.h"
 
 #include <chrono>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <boost/functional/hash.hpp>
 
 #include "../macros.h"
 
 using namespace std;
 
 follower_solver_base::follower_solver_base(const problem& prob) :
-	model_single(prob), time(0) { }
+	model_single(prob), time(0)
+{
+	map<int, int> group_of_origin;
+	LOOP(k, K) {
+		int origin = prob.commodities[k].origin;
+		auto it = group_of_origin.find(origin);
+		if (it == group_of_origin.end()) {
+			group_of_origin.emplace(origin, origin_groups.size());
+			origin_groups.push_back({ k });
+		}
+		else
+			origin_groups[it->second].push_back(k);
+	}
+}
 
 std::vector<follower_solver_base::path> follower_solver_base::solve(const std::vector<cost_type>& tolls)
 {
@@ -21,6 +38,76 @@ std::vector<follower_solver_base::path> follower_solver_base::solve(const std::v
 	return paths;
 }
 
+// Arc-major copy of a toll matrix: column a holds the tolls of arc a in all N vectors
+static vector<cost_type> arc_major(const follower_solver_base::toll_matrix& tolls, int A1)
+{
+	int N = tolls.size();
+	vector<cost_type> columns(A1 * N);
+	LOOP(i, N) {
+		LOOP(a, A1) columns[a * N + i] = tolls[i][a];
+	}
+	return columns;
+}
+
+// Contiguous and non-aliasing, so the compiler emits packed SIMD additions
+static void add_column(cost_type* __restrict sum, const cost_type* __restrict column, int N)
+{
+	LOOP(i, N) sum[i] += column[i];
+}
+
+follower_solver_base::batch_result follower_solver_base::solve_batch(const toll_matrix& tolls)
+{
+	int N = tolls.size();
+
+	batch_result result;
+	result.paths.reserve(N);
+	for (const auto& t : tolls)
+		result.paths.push_back(solve(t));
+
+	// Toll vectors and commodities using each distinct path
+	unordered_map<path, vector<pair<int, int>>, boost::hash<path>> users;
+	LOOP(i, N) {
+		LOOP(k, K) {
+			if (!result.paths[i][k].empty())
+				users[result.paths[i][k]].emplace_back(i, k);
+		}
+	}
+
+	vector<cost_type> columns = arc_major(tolls, A1);
+	vector<cost_type> dense(N);
+	toll_matrix path_tolls(N, vector<cost_type>(K, 0));
+
+	for (const auto& entry : users) {
+		path_incidence inc = get_incidence(entry.first);
+
+		// Frequent path: one vectorized pass over its tolled arcs for all vectors
+		if ((int)entry.second.size() * DENSE_RATIO >= N) {
+			fill(dense.begin(), dense.end(), 0);
+			for (int a : inc.tolled)
+				add_column(dense.data(), &columns[a * N], N);
+
+			for (const auto& user : entry.second)
+				path_tolls[user.first][user.second] = dense[user.first];
+		}
+		// Rare path: sum only for its users
+		else {
+			for (const auto& user : entry.second) {
+				cost_type sum = 0;
+				for (int a : inc.tolled)
+					sum += tolls[user.first][a];
+				path_tolls[user.first][user.second] = sum;
+			}
+		}
+	}
+
+	result.revenues.assign(N, 0);
+	LOOP(i, N) {
+		LOOP(k, K) result.revenues[i] += path_tolls[i][k] * prob.commodities[k].demand;
+	}
+
+	return result;
+}
+
 cost_type follower_solver_base::get_cost(const path& p, const std::vector<cost_type>& tolls) const
 {
 	cost_type cost = 0;
@@ -38,3 +125,35 @@ cost_type follower_solver_base::get_cost(const path& p, const std::vector<cost_t
 }
 
 
+
+follower_solver_base::path_incidence follower_solver_base::get_incidence(const path& p) const
+{
+	path_incidence inc{ 0, {} };
+
+	for (int i = 0; i + 1 < (int)p.size(); ++i) {
+		auto edge = EDGE_FROM_SRC_DST(prob, p[i], p[i + 1]);
+		inc.base_cost += prob.cost_map[edge];
+
+		if (prob.is_tolled_map[edge])
+			inc.tolled.push_back(EDGE_TO_A1(prob, edge));
+	}
+
+	return inc;
+}
+
+follower_solver_base::toll_matrix follower_solver_base::get_costs(const vector<path>& paths, const toll_matrix& tolls) const
+{
+	int N = tolls.size();
+	vector<cost_type> columns = arc_major(tolls, A1);
+
+	toll_matrix costs(paths.size());
+	LOOP(p, (int)paths.size()) {
+		path_incidence inc = get_incidence(paths[p]);
+
+		costs[p].assign(N, inc.base_cost);
+		for (int a : inc.tolled)
+			add_column(costs[p].data(), &columns[a * N], N);
+	}
+
+	return costs;
+}
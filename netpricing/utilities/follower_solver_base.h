@@ -8,10 +8,40 @@ struct follower_solver_base : public model_single
 	using path = std::vector<int>;
 	double time;
 
+	// One toll vector per row
+	using toll_matrix = std::vector<std::vector<cost_type>>;
+
+	// Commodities grouped by origin (in order of first appearance)
+	std::vector<std::vector<int>> origin_groups;
+
+	// Toll-free cost and tolled arcs (A1 indices) of a path
+	struct path_incidence {
+		cost_type base_cost;
+		std::vector<int> tolled;
+	};
+
+	struct batch_result {
+		std::vector<std::vector<path>> paths;		// paths[i][k]: path of commodity k under toll vector i
+		std::vector<cost_type> revenues;			// Leader revenue of each toll vector
+	};
+
+	// A distinct path used by at least N / DENSE_RATIO toll vectors is costed for all of them in one pass
+	constexpr static int DENSE_RATIO = 8;
+
+	// Tolls are scaled by this factor, so that ties prefer tolled arcs (divide the revenue by it)
+	constexpr static double TOLL_PREFERENCE = 0.9999;
+
 	follower_solver_base(const problem& prob);
 
 	std::vector<path> solve(const std::vector<cost_type>& tolls);
 	virtual std::vector<path> solve_impl(const std::vector<cost_type>& tolls) = 0;
 
+	// Solve many toll vectors, paths repeated across vectors are walked only once
+	batch_result solve_batch(const toll_matrix& tolls);
+
 	cost_type get_cost(const path& p, const std::vector<cost_type>& tolls) const;
+	path_incidence get_incidence(const path& p) const;
+
+	// Costs of the paths under every toll vector (costs[p][i])
+	toll_matrix get_costs(const std::vector<path>& paths, const toll_matrix& tolls) const;
 };
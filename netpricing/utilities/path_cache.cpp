@@ -0,0 +1,215 @@
+#include "path_cache.h"
+
+#include "../problem.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <random>
+#include <experimental/filesystem>
+
+using namespace std;
+namespace fs = std::experimental::filesystem;
+
+static void write_varint(ostream& os, uint64_t x)
+{
+	while (x >= 0x80) {
+		os.put((char)(x | 0x80));
+		x >>= 7;
+	}
+	os.put((char)x);
+}
+
+static bool read_varint(istream& is, uint64_t& x)
+{
+	x = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		int c = is.get();
+		if (c == EOF)
+			return false;
+		x |= (uint64_t)(c & 0x7f) << shift;
+		if (!(c & 0x80))
+			return true;
+	}
+	return false;
+}
+
+static uint64_t zigzag(int64_t x) { return ((uint64_t)x << 1) ^ (uint64_t)(x >> 63); }
+static int64_t unzigzag(uint64_t x) { return (int64_t)(x >> 1) ^ -(int64_t)(x & 1); }
+
+path_cache::path_cache() :
+	hits(0), misses(0)
+{
+}
+
+void path_cache::open(const std::string& dir, const problem& prob)
+{
+	this->dir = dir;
+
+	stringstream ss;
+	ss << hex << setw(16) << setfill('0') << hash_problem(prob);
+	instance = ss.str();
+}
+
+vector<path_cache::path> path_cache::get(const std::string& method, int k, bool spgm, int num_paths,
+										 const enumerate_func& enumerate)
+{
+	vector<path> paths;
+	bool complete;
+
+	if (enabled() && load(method, k, spgm, paths, complete) && (complete || (int)paths.size() >= num_paths)) {
+		if ((int)paths.size() > num_paths)
+			paths.resize(num_paths);
+		hits++;
+		return paths;
+	}
+
+	paths = enumerate(num_paths);
+
+	if (enabled()) {
+		misses++;
+		store(method, k, spgm, paths, num_paths > 0 && (int)paths.size() < num_paths);
+	}
+	return paths;
+}
+
+bool path_cache::load(const std::string& method, int k, bool spgm, vector<path>& paths, bool& complete) const
+{
+	error_code ec;
+	fs::path entry = entry_dir(method, k, spgm);
+	if (!fs::is_directory(entry, ec))
+		return false;
+
+	// Prefer a complete enumeration, then the largest one
+	fs::path best = entry / "all.paths";
+	if (!fs::exists(best, ec)) {
+		long long best_count = -1;
+		best.clear();
+		for (auto& file : fs::directory_iterator(entry, ec)) {
+			if (file.path().extension() != ".paths")
+				continue;
+			try {
+				long long count = stoll(file.path().stem().string());
+				if (count > best_count) {
+					best_count = count;
+					best = file.path();
+				}
+			}
+			catch (const std::exception&) {}
+		}
+		if (best.empty())
+			return false;
+	}
+
+	ifstream is(best.string(), ios::binary);
+	return is && read_paths(is, paths, complete);
+}
+
+void path_cache::store(const std::string& method, int k, bool spgm, const vector<path>& paths, bool complete) const
+{
+	error_code ec;
+	fs::path entry = entry_dir(method, k, spgm);
+	fs::create_directories(entry, ec);
+	if (ec)
+		return;
+
+	// Written aside then renamed, so concurrent runs never read a partial file
+	fs::path target = entry / (complete ? string("all.paths") : to_string(paths.size()) + ".paths");
+	fs::path temp = target;
+	temp += ".tmp" + to_string(random_device()());
+	{
+		ofstream os(temp.string(), ios::binary);
+		write_paths(os, paths, complete);
+		if (!os) {
+			fs::remove(temp, ec);
+			return;
+		}
+	}
+	fs::rename(temp, target, ec);
+	if (ec) {
+		fs::remove(temp, ec);
+		return;
+	}
+
+	// Smaller partial entries are now redundant
+	for (auto& file : fs::directory_iterator(entry, ec)) {
+		if (file.path() == target || file.path().extension() != ".paths")
+			continue;
+		try {
+			if (complete || stoll(file.path().stem().string()) < (long long)paths.size())
+				fs::remove(file.path(), ec);
+		}
+		catch (const std::exception&) {}
+	}
+}
+
+uint64_t path_cache::hash_problem(const problem& prob)
+{
+	// FNV-1a of the canonical JSON form (std::hash is not stable across builds)
+	string data = problem::get_json(prob).dump();
+	uint64_t h = 0xcbf29ce484222325ULL;
+	for (unsigned char c : data) {
+		h ^= c;
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+void path_cache::write_paths(std::ostream& os, const vector<path>& paths, bool complete)
+{
+	os.write((const char*)&MAGIC, sizeof(MAGIC));
+	os.write((const char*)&VERSION, sizeof(VERSION));
+	os.put(complete ? 1 : 0);
+	write_varint(os, paths.size());
+
+	for (const path& p : paths) {
+		write_varint(os, p.size());
+		int64_t last = 0;
+		for (int v : p) {
+			write_varint(os, zigzag(v - last));
+			last = v;
+		}
+	}
+}
+
+bool path_cache::read_paths(std::istream& is, vector<path>& paths, bool& complete)
+{
+	uint32_t magic, version;
+	is.read((char*)&magic, sizeof(magic));
+	is.read((char*)&version, sizeof(version));
+	int flag = is.get();
+	if (!is || magic != MAGIC || version != VERSION)
+		return false;
+	complete = flag != 0;
+
+	uint64_t num_paths;
+	if (!read_varint(is, num_paths))
+		return false;
+
+	paths.clear();
+	paths.reserve(num_paths);
+	for (uint64_t i = 0; i < num_paths; i++) {
+		uint64_t len, delta;
+		if (!read_varint(is, len))
+			return false;
+
+		path p(len);
+		int64_t last = 0;
+		for (auto& v : p) {
+			if (!read_varint(is, delta))
+				return false;
+			last += unzigzag(delta);
+			v = last;
+		}
+		paths.push_back(std::move(p));
+	}
+
+	// Trailing data means a foreign or corrupted file
+	return is.peek() == EOF;
+}
+
+std::string path_cache::entry_dir(const std::string& method, int k, bool spgm) const
+{
+	fs::path entry = fs::path(dir) / instance / (method + (spgm ? "-spgm-" : "-orig-") + to_string(k));
+	return entry.string();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+
+struct problem;
+
+// Content-addressed on-disk cache of enumerated paths
+// Entries live in <dir>/<instance hash>/<method>-<graph>-<commodity>/<count>.paths (or all.paths if complete)
+// An enumeration with N paths is a prefix of any enumeration with more paths, so larger entries serve smaller requests
+struct path_cache
+{
+	using path = std::vector<int>;
+	using enumerate_func = std::function<std::vector<path>(int)>;
+
+	constexpr static uint32_t MAGIC = 0x4350504e;	// "NPPC"
+	constexpr static uint32_t VERSION = 1;
+
+	std::string dir;		// Empty = disabled
+	std::string instance;
+
+	// Statistics (commodities may be served concurrently)
+	std::atomic<int> hits;
+	std::atomic<int> misses;
+
+	path_cache();
+
+	void open(const std::string& dir, const problem& prob);
+	bool enabled() const { return !dir.empty(); }
+
+	// First num_paths paths of commodity k, served from the cache if possible
+	// Otherwise enumerate(num_paths) is called and its result is stored
+	std::vector<path> get(const std::string& method, int k, bool spgm, int num_paths,
+						  const enumerate_func& enumerate);
+
+	// Largest entry of commodity k (a complete one if any), false if there is none
+	bool load(const std::string& method, int k, bool spgm, std::vector<path>& paths, bool& complete) const;
+	void store(const std::string& method, int k, bool spgm, const std::vector<path>& paths, bool complete) const;
+
+	static uint64_t hash_problem(const problem& prob);
+
+	// Compact binary form (zigzag varint deltas of node indices)
+	static void write_paths(std::ostream& os, const std::vector<path>& paths, bool complete);
+	static bool read_paths(std::istream& is, std::vector<path>& paths, bool& complete);
+
+private:
+	std::string entry_dir(const std::string& method, int k, bool spgm) const;
+};
@@ -0,0 +1,51 @@
+#include "skeleton_follower_solver.h"
+#include "../hybrid/preprocessors/skeleton_preprocessor.h"
+#include "distance_oracle.h"
+#include "../macros.h"
+
+#include <chrono>
+
+using namespace std;
+
+skeleton_follower_solver::skeleton_follower_solver(const problem& prob) :
+	follower_solver_base(prob), toll_overlay(A1, 0), preprocess_time(0)
+{
+	auto start = chrono::high_resolution_clock::now();
+
+	// Silent preprocessing
+	ostream null_log(nullptr);
+	distance_oracle oracle(prob);
+	skeleton_preprocessor preproc;
+	preproc.log = &null_log;
+	preproc.oracle = &oracle;
+
+	infos.reserve(K);
+	graphs.reserve(K);
+	LOOP(k, K) {
+		infos.push_back(preproc.preprocess(prob, k));
+		graphs.push_back(infos[k].build_graph());
+
+		// Destinations are fixed, so A* potentials are computed once
+		graphs[k].search = light_graph::ASTAR;
+		graphs[k].potential(prob.commodities[k].destination);
+	}
+
+	auto end = chrono::high_resolution_clock::now();
+	preprocess_time = chrono::duration<double>(end - start).count();
+}
+
+vector<skeleton_follower_solver::path> skeleton_follower_solver::solve_impl(const vector<cost_type>& tolls)
+{
+	LOOP(a, A1) toll_overlay[a] = tolls[a] * TOLL_PREFERENCE;		// Prefer tolled arcs
+
+	vector<path> paths(K);
+	light_workspace& ws = light_workspace::local();
+
+	LOOP(k, K) {
+		const commodity& comm = prob.commodities[k];
+		path p = graphs[k].shortest_path(ws, comm.origin, comm.destination, &toll_overlay);
+		paths[k] = infos[k].expand_path(p);
+	}
+
+	return paths;
+}
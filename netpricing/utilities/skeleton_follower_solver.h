@@ -0,0 +1,22 @@
+#pragma once
+
+#include "follower_solver_base.h"
+#include "../graph/light_graph.h"
+#include "../hybrid/base/preprocessor.h"
+
+// Follower solver on the per-commodity skeleton graphs (see skeleton_preprocessor)
+// The paths are expanded back to the original graph
+struct skeleton_follower_solver : public follower_solver_base
+{
+	std::vector<preprocess_info> infos;
+	std::vector<light_graph> graphs;
+
+	// Tolls of the last solve (skeleton tolled arcs keep their A1 index)
+	light_graph::toll_overlay toll_overlay;
+
+	double preprocess_time;
+
+	skeleton_follower_solver(const problem& prob);
+
+	virtual std::vector<path> solve_impl(const std::vector<cost_type>& tolls) override;
+};
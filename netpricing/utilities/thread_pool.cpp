@@ -0,0 +1,89 @@
+#include "thread_pool.h"
+
+using namespace std;
+
+thread_pool::thread_pool(int num_threads) :
+	job(nullptr), num_jobs(0), next_job(0), busy(0), round(0), stopping(false)
+{
+	for (int i = 1; i < num_threads; i++)
+		workers.emplace_back(&thread_pool::worker_loop, this);
+}
+
+thread_pool::~thread_pool()
+{
+	{
+		lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	start_cv.notify_all();
+
+	for (auto& worker : workers)
+		worker.join();
+}
+
+void thread_pool::run(int n, const job_type& job)
+{
+	// Nothing to share
+	if (workers.empty() || n <= 1) {
+		for (int i = 0; i < n; i++)
+			job(i);
+		return;
+	}
+
+	{
+		lock_guard<std::mutex> lock(mutex);
+		this->job = &job;
+		num_jobs = n;
+		next_job = 0;
+		busy = workers.size();
+		error = nullptr;
+		++round;
+	}
+	start_cv.notify_all();
+
+	work();
+
+	unique_lock<std::mutex> lock(mutex);
+	done_cv.wait(lock, [this] { return busy == 0; });
+	this->job = nullptr;
+
+	if (error)
+		rethrow_exception(error);
+}
+
+void thread_pool::work()
+{
+	for (int i = next_job++; i < num_jobs; i = next_job++) {
+		try {
+			(*job)(i);
+		}
+		catch (...) {
+			lock_guard<std::mutex> lock(mutex);
+			if (!error)
+				error = current_exception();
+
+			// Skip the remaining jobs
+			next_job = num_jobs;
+		}
+	}
+}
+
+void thread_pool::worker_loop()
+{
+	unsigned int seen = 0;
+
+	unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		start_cv.wait(lock, [&] { return stopping || round != seen; });
+		if (stopping)
+			return;
+		seen = round;
+
+		lock.unlock();
+		work();
+		lock.lock();
+
+		if (--busy == 0)
+			done_cv.notify_one();
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+
+// Fixed set of worker threads running indexed jobs
+// The calling thread takes part in every run, so a pool of size 1 has no worker
+struct thread_pool
+{
+	using job_type = std::function<void(int)>;
+
+	std::vector<std::thread> workers;
+
+	std::mutex mutex;
+	std::condition_variable start_cv;
+	std::condition_variable done_cv;
+
+	// Current run
+	const job_type* job;
+	int num_jobs;
+	std::atomic<int> next_job;
+	int busy;
+	unsigned int round;
+	bool stopping;
+	std::exception_ptr error;
+
+	thread_pool(int num_threads);
+	~thread_pool();
+
+	int size() const { return workers.size() + 1; }
+
+	// Run job(i) for all i in [0, n) and wait for completion
+	// Jobs are picked dynamically, the first exception thrown is rethrown here
+	void run(int n, const job_type& job);
+
+private:
+	void work();
+	void worker_loop();
+};
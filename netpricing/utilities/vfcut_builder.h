@@ -11,7 +11,7 @@ struct vfcut_builder : public cplex_def
 
 	IloEnv env;
 	follower_light_solver solver;
-	problem& prob;
+	const problem& prob;
 
 	VarMatrix x;
 	VarMatrix y;